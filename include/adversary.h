@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: MIT License
+/* adversary.h -- header of the search for puzzles hard to the solver
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef ADVERSARY_H
+#define ADVERSARY_H
+
+#include <search.h>
+#include <generate.h>
+
+/* fitness of a puzzle */
+#define ADVERSARY_NODES 0 /* guesses to the first solution */
+#define ADVERSARY_TIME 1 /* seconds to the first solution */
+
+typedef struct adversary {
+    int order; /* order of puzzles */
+    int scale; /* scale of number */
+    int size; /* size of puzzles */
+    search_t *settings; /* the heuristics under attack, owned by the caller */
+    int fitness; /* guesses or seconds */
+    int unique; /* 1 to keep to puzzles of one solution */
+    long steps; /* mutations tried by every climb */
+    long limit; /* guesses a puzzle is measured by at most, 0 for no limit */
+    long evaluated; /* puzzles measured */
+    generate_t *gen; /* the grids to climb on */
+    cell_t *grid; /* the solution of the climb */
+    cell_t *map; /* the puzzle of the climb */
+    cell_t *trial; /* the mutated puzzle */
+    cell_t *best; /* the hardest puzzle of the last climb */
+    double score; /* the fitness of best */
+}adversary_t;
+
+/* create an adversary of puzzles of order, solved by searches set up like settings
+ * returns NULL if order is out of 2 to 11
+ */
+adversary_t *adversary_create(int order, search_t *settings);
+
+/* free the adversary, the settings are not freed */
+void adversary_free(adversary_t *adv);
+
+/* the fitness of a puzzle, or -1 if it has no solution, or more than one while unique is set
+ * a puzzle stopped by the limit scores the guesses or time spent, without the check of unique
+ */
+double adversary_score(adversary_t *adv, cell_t *map);
+
+/* climb from a puzzle of the grid of seed, trying steps mutations of its clues
+ * returns the fitness of the hardest puzzle met, which is left in best
+ */
+double adversary_climb(adversary_t *adv, unsigned long long seed);
+
+#endif
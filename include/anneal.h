@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MIT License
+/* anneal.h -- header of the stochastic local search for large sparse puzzles
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef ANNEAL_H
+#define ANNEAL_H
+
+#include <puzzle.h>
+
+/* temperature kept after every round of moves */
+#ifndef ANNEAL_COOLING
+#define ANNEAL_COOLING 0.99
+#endif
+/* rounds without a new best before the chain is heated again */
+#define ANNEAL_STALL 40
+/* guesses of the exact search at every handoff */
+#define ANNEAL_BUDGET 10000
+
+typedef struct anneal_chain {
+    int index; /* the place in chains */
+    cell_t *map; /* the grid of the chain, every chunk holding every number once */
+    char *fixed; /* givens, never moved */
+    int *frees; /* free cells of every chunk, chunk after chunk */
+    int *starts; /* the first free cell of every chunk in frees, and the end */
+    int *movable; /* chunks with two free cells or more */
+    int movables; /* count of movable chunks */
+    unsigned short *rows; /* count of every number in every row */
+    unsigned short *cols; /* count of every number in every col */
+    int cost; /* numbers missing from rows and cols, 0 for a solution */
+    int best; /* the lowest cost met */
+    double hot; /* the temperature to start and reheat at */
+    double temperature; /* the temperature now */
+    unsigned long long state; /* random state */
+    long moves; /* swaps tried */
+    long rounds; /* rounds of cooling */
+    long reheats; /* times heated again */
+    long handoffs; /* times handed to the exact search */
+    int finish; /* 0 not solved, 1 solved by annealing, 2 solved by a handoff */
+    double seconds; /* time run */
+    struct anneal *anneal; /* the race it is in */
+}anneal_chain_t;
+
+typedef struct anneal {
+    int order; /* order of the puzzle */
+    int scale; /* scale of the puzzle */
+    int size; /* size of the puzzle */
+    cell_t *givens; /* the map of the puzzle */
+    int count; /* the count of chains */
+    anneal_chain_t *chains; /* one chain for every thread */
+    double seconds; /* time to give up after */
+    int handoff; /* hand a chain to the exact search once this few numbers are missing, 0 never */
+    long budget; /* guesses of the exact search at every handoff */
+    int done; /* set by the first chain to solve */
+    int winner; /* the first chain to solve, -1 if none */
+    cell_t *solution; /* the solution of the winner */
+}anneal_t;
+
+/* create count chains over puzzle, chain i seeded by seed + i
+ * returns NULL if the givens clash
+ */
+anneal_t *anneal_create(puzzle_t *puzzle, int count, unsigned long long seed);
+
+void anneal_free(anneal_t *anneal);
+
+/* run every chain on its own thread until one solves or time is up
+ * returns 1 with a validated solution in solution, or 0 if none was found, which proves nothing
+ */
+int anneal_run(anneal_t *anneal);
+
+#endif
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MIT License
+/* archive.h -- header of compact archives of solved grids
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <search.h>
+
+#include <stdio.h>
+
+/* grids coded together, the unit of random access */
+#define ARCHIVE_BLOCK 4096
+
+typedef struct archive_codec {
+    int order; /* order of grids */
+    int scale; /* scale of grids */
+    int size; /* size of grids */
+    mask_t full; /* every number in scale */
+    int *peers; /* cells sharing a row, col or chunk with every cell */
+    int peercount; /* peers of every cell */
+    int *members; /* cells of every row, col and chunk */
+    int *units; /* row, col and chunk of every cell */
+    mask_t *cands; /* numbers left for every cell of the grid being coded */
+    int *queue; /* cells left with one number and not propagated yet */
+    unsigned char *places; /* places left to every number in every row, col and chunk */
+    int *checks; /* numbers of units left with one place, to be placed */
+}archive_codec_t;
+
+typedef struct archive {
+    FILE *pf; /* the archive file */
+    int writing; /* opened to write */
+    archive_codec_t *codec; /* codec of the order of the archive */
+    long blocks; /* blocks in the archive */
+    long grids; /* grids in the archive */
+    long capacity; /* capacity of offsets and counts */
+    long *offsets; /* file offset of every block, and the index after the last one */
+    int *counts; /* grids in every block */
+    cell_t *pending; /* maps written and not coded yet */
+    int waiting; /* maps in pending */
+    unsigned char *buffer; /* coded bytes of a block */
+}archive_t;
+
+/* create a codec for grids of order up to 11; returns NULL if out of range */
+archive_codec_t *archive_codec_create(int order);
+
+void archive_codec_free(archive_codec_t *codec);
+
+/* returns the most bytes count grids can take */
+long archive_bound(archive_codec_t *codec, int count);
+
+/* code count solved grids laid one after another in maps into out
+ * returns the count of bytes, or -1 - k if grid k is not a valid complete grid
+ */
+long archive_encode(archive_codec_t *codec, cell_t *maps, int count, unsigned char *out);
+
+/* decode count grids from length bytes of in into maps; returns 0 if the bytes are broken */
+int archive_decode(archive_codec_t *codec, unsigned char *in, long length, int count, cell_t *maps);
+
+/* create an archive of grids of order at path; returns NULL if not writable */
+archive_t *archive_create(char *path, int order);
+
+/* open an archive at path to read; returns NULL if missing or not an archive */
+archive_t *archive_open(char *path);
+
+/* add a grid to an archive opened to write; returns 0 if it is not a valid complete grid */
+int archive_write(archive_t *archive, cell_t *map);
+
+/* add a block coded by archive_encode of count grids; returns 0 if failed to write */
+int archive_append(archive_t *archive, unsigned char *data, long length, int count);
+
+/* decode block of an archive opened to read into maps of ARCHIVE_BLOCK grids at most
+ * returns the count of grids, or -1 if the block is missing or broken
+ */
+int archive_read(archive_t *archive, long block, cell_t *maps);
+
+/* write what is left and the index if writing, and free the archive; returns 0 if failed */
+int archive_close(archive_t *archive);
+
+#endif
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT License
+/* batch.h -- header of the lockstep batch solver for 9x9 puzzles
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <puzzle.h>
+
+/* puzzles propagated at once, one in every lane of a vector */
+#ifndef BATCH_LANES
+#define BATCH_LANES 16
+#endif
+
+typedef struct batch_stats {
+    long puzzles; /* puzzles taken */
+    long propagated; /* solved by lockstep propagation alone */
+    long fallbacks; /* handed to the scalar search to branch */
+    long unsolvable; /* proved to have no solution */
+    long rounds; /* lockstep propagation rounds */
+}batch_stats_t;
+
+/* solve puzzles in place, 9x9 ones BATCH_LANES at a time and the others by the search
+ * an unsolvable puzzle is left as it was
+ * returns the count of solved puzzles
+ */
+int batch_solve(puzzle_t **puzzles, int count, batch_stats_t *stats);
+
+#endif
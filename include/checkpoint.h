@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT License
+/* checkpoint.h -- header of search checkpoints
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <search.h>
+
+#include <pthread.h>
+
+typedef struct checkpoint {
+    char *path; /* the checkpoint file */
+    char *temp; /* the file written first and renamed over path */
+    int *buffer; /* snapshot of the search being written */
+    int length; /* ints used in buffer */
+    int capacity; /* capacity of buffer */
+    pthread_t writer; /* the thread writing buffer */
+    int started; /* a writer has been started and not joined */
+    int busy; /* the writer is still writing */
+    int failed; /* the last write failed */
+    long written; /* checkpoints written */
+    long skipped; /* checkpoints skipped while the writer was busy */
+}checkpoint_t;
+
+/* create checkpoints of search to path */
+checkpoint_t *checkpoint_create(char *path, search_t *search);
+
+/* wait for the writer and free the checkpoint */
+void checkpoint_free(checkpoint_t *checkpoint);
+
+/* snapshot the search and write it in the background; returns 0 if skipped as the writer is busy */
+int checkpoint_save(checkpoint_t *checkpoint, search_t *search);
+
+/* wait for the writer; returns 0 if the last write failed */
+int checkpoint_wait(checkpoint_t *checkpoint);
+
+/* restore the search created over the same puzzle from path; returns 0 if missing or not fitting */
+int checkpoint_load(char *path, search_t *search);
+
+#endif
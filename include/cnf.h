@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: MIT License
+/* cnf.h -- header of the cnf encoding of sudoku
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef CNF_H
+#define CNF_H
+
+#include <puzzle.h>
+#include <sat.h>
+
+typedef struct cnf {
+    int order; /* order of puzzle */
+    int scale; /* scale of number */
+    int size; /* size of puzzle */
+    cell_t *map; /* the givens */
+    int *vars; /* variable of number n on cell at scale*cell+n-1, 0 if impossible */
+    int totalvar; /* the total amount of variables, auxiliary ones included */
+    int totalclause; /* the total amount of clauses */
+    int *lits; /* clauses as dimacs literals, every clause ends with 0 */
+    int length; /* used length of lits */
+    int capacity; /* capacity of lits */
+}cnf_t;
+
+/* encode the puzzle as exactly-one constraints of cells, rows, cols and chunks */
+cnf_t *cnf_encode(puzzle_t *puzzle);
+
+/* free the encoding */
+void cnf_free(cnf_t *cnf);
+
+/* write the encoding in dimacs format; returns 1 success or 0 error */
+int cnf_write_dimacs(char *path, cnf_t *cnf);
+
+/* load the encoding into a new sat solver */
+sat_t *cnf_load(cnf_t *cnf);
+
+/* decode the model of a solved sat solver into map */
+void cnf_decode(cnf_t *cnf, sat_t *sat, cell_t *map);
+
+#endif
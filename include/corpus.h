@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: MIT License
+/* corpus.h -- header of text formats for streams of puzzles
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <puzzle.h>
+
+/* one map per line, numbers separated by spaces and 0 for void */
+#define CORPUS_LINE 0
+/* one map per line, one symbol per cell and '.' for void, scale up to 88 */
+#define CORPUS_COMPACT 1
+
+/* returns the format by name, or -1 if unknown */
+int corpus_format(char *name);
+
+/* returns the buffer length needed to print a map of size */
+int corpus_length(int format, int size);
+
+/* print a map as one line ending with '\n'; returns the length, or 0 if scale doesn't fit */
+int corpus_print(char *text, int format, cell_t *map, int scale, int size);
+
+/* parse one line of a corpus into map holding at most capacity cells; returns the count of cells or -1 */
+int corpus_parse(char *text, int format, cell_t *map, int capacity);
+
+/* the number of every byte as a symbol of compact format, 0 for void and -1 for none */
+const signed char *corpus_numbers();
+
+/* the order of a map of size cells, 0 if size is not a fourth power */
+int corpus_order(int size);
+
+#endif
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: MIT License
+/* count.h -- header of exact counting of completions
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef COUNT_H
+#define COUNT_H
+
+#include <puzzle.h>
+
+/* counts of completions, up to 2^128 - 1 */
+typedef unsigned __int128 count_total_t;
+
+/* longest decimal of a count_total_t with its end */
+#define COUNT_DIGITS 40
+
+/* most states after a row by default, about a gigabyte at order 3 */
+#define COUNT_STATES 4000000
+
+/* most rounds of sorting numbers, cols and stacks to a canonical state */
+#define COUNT_ROUNDS 4
+
+typedef struct count {
+    puzzle_t *puzzle; /* puzzle to count */
+    long limit; /* most states after a row, 0 for no limit */
+    count_total_t total; /* completions */
+    int overflow; /* total reached 2^128, so it's wrong */
+    int stopped; /* the row whose states ran over limit, -1 if none */
+    long states; /* canonical states kept over all rows */
+    long widest; /* most canonical states after a row */
+    long fillings; /* rows filled on every state */
+    double seconds; /* seconds of counting */
+}count_t;
+
+/* create an exact counter of puzzle; returns NULL if scale is too large */
+count_t *count_create(puzzle_t *puzzle);
+
+void count_free(count_t *count);
+
+/* count the completions of the puzzle row by row, merging partial grids equal up to the
+ * symmetries keeping the givens of the rows left
+ * returns 1, 0 if the total overflowed, or -1 if the states of a row ran over limit
+ */
+int count_exact(count_t *count);
+
+/* count the completions by the search one solution at a time; returns -1 if scale is too large */
+long count_search(puzzle_t *puzzle);
+
+/* write total in decimal to text, at least COUNT_DIGITS long; returns its length */
+int count_print(char *text, count_total_t total);
+
+#endif
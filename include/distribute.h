@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT License
+/* distribute.h -- header of multi-process search over job files
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef DISTRIBUTE_H
+#define DISTRIBUTE_H
+
+#include <puzzle.h>
+
+#include <stdio.h>
+
+/* results hold the count only */
+#define DISTRIBUTE_COUNT 0
+/* results hold the solutions in a corpus format and the count */
+#define DISTRIBUTE_SOLUTIONS 1
+
+/* write a job file into dir for every node at the frontier of split guesses
+ * returns the count of jobs, or -1 if scale is too large or dir is not writable
+ */
+int distribute_split(puzzle_t *puzzle, char *dir, int split);
+
+/* run a job file and write its result file, solutions in format if emit is DISTRIBUTE_SOLUTIONS
+ * limit is the most solutions to find, 0 for all of them
+ * returns the count of solutions, or -1 if the job is broken
+ */
+long distribute_job(char *jobpath, char *resultpath, int emit, int format, long limit);
+
+/* claim and run the jobs of dir one by one until none is left, for workers sharing a filesystem
+ * a claim left by a dead process of this host, or older than stale seconds, is taken over
+ * stale is 0 to never take over by age, or -1 to take over every claim
+ * returns the count of jobs run
+ */
+int distribute_work(char *dir, int emit, int format, long limit, long stale);
+
+/* run the jobs of dir by workers forked locally, fed with job names over pipes
+ * returns the count of solutions, stopping early once limit is reached if not 0
+ */
+long distribute_local(char *dir, int workers, int emit, int format, long limit);
+
+/* add up the results of dir and copy their solutions to pf if not NULL
+ * returns the count of solutions, missing is set to the count of jobs without a result
+ */
+long distribute_merge(char *dir, FILE *pf, int *missing);
+
+#endif
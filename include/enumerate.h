@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: MIT License
+/* enumerate.h -- header of streaming enumeration of solutions
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef ENUMERATE_H
+#define ENUMERATE_H
+
+#include <puzzle.h>
+
+#include <stdio.h>
+
+/* stream the solutions of puzzle to pf in a corpus format as they are found
+ * limit is the most solutions to write, 0 for all of them
+ * with more than one thread, the search tree is split on the first split guesses
+ * returns the count of solutions written, or -1 if scale is too large
+ */
+long enumerate_main(puzzle_t *puzzle, FILE *pf, int format, long limit, int threads, int split);
+
+/* expand the search tree to the frontier of split guesses, every node makes a job
+ * returns the decisions of every job as split pairs of cell and number, -1 for unused
+ */
+int *enumerate_frontier(puzzle_t *puzzle, int split, int *totaljob);
+
+#endif
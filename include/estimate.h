@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT License
+/* estimate.h -- header of the search tree size estimator
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include <search.h>
+#include <puzzle.h>
+
+/* probes and seconds of an estimate by default */
+#define ESTIMATE_PROBES 64
+#define ESTIMATE_SECONDS 1.0
+
+typedef struct estimate {
+    search_t *search; /* the search probed, its branching and propagation are the ones estimated */
+    unsigned long long seed; /* seed of the random choices */
+    int limit; /* most probes */
+    int first; /* stop at the first probe reaching a solution, for a search stopping there */
+    double budget; /* most seconds of probing */
+    int probes; /* probes run */
+    int solutions; /* probes ending at a solution */
+    int deepest; /* most guesses of a probe */
+    double nodes; /* estimated guesses to exhaust the tree, or to the first solution if first */
+    double low; /* lower end of the 95% confidence interval of nodes */
+    double high; /* upper end of the 95% confidence interval of nodes */
+    double pernode; /* seconds of the probes per propagation */
+    double seconds; /* estimated seconds to exhaust the tree */
+    double spent; /* seconds of probing */
+}estimate_t;
+
+/* create an estimator over puzzle; returns NULL if scale is too large for search
+ * the heuristics of search may be set before running
+ */
+estimate_t *estimate_create(puzzle_t *puzzle);
+
+void estimate_free(estimate_t *estimate);
+
+/* probe random paths from the root to a leaf until limit probes or budget seconds,
+ * or until a probe reaches a solution if first
+ * returns the count of probes run
+ */
+int estimate_run(estimate_t *estimate);
+
+#endif
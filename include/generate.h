@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT License
+/* generate.h -- header of random complete grid generation
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <archive.h>
+#include <search.h>
+
+#include <stdio.h>
+
+typedef struct generate {
+    int order; /* order of grids */
+    int scale; /* scale of number */
+    int size; /* size of grids */
+    search_t *search; /* the search over an empty grid, reused by every grid */
+    cell_t *map; /* the grid found by the search before shuffling */
+    long retries; /* searches given up for taking too long */
+}generate_t;
+
+/* create a generator of grids of order; returns NULL if order is out of 2 to 11 */
+generate_t *generate_create(int order);
+
+/* free the generator and its search */
+void generate_free(generate_t *gen);
+
+/* write a random complete grid into map, the same seed gives the same grid */
+void generate_grid(generate_t *gen, unsigned long long seed, cell_t *map);
+
+/* stream count random grids of order to pf in a corpus format, grid k made from seed and k
+ * threads share the grids, so the order of lines differs between runs but the set doesn't
+ * returns the count of grids written, or -1 if order is out of range
+ */
+long generate_main(int order, FILE *pf, int format, long count, int threads, unsigned long long seed);
+
+/* the same as generate_main, but the grids are coded to archive by blocks of ARCHIVE_BLOCK
+ * returns the count of grids written, or -1 if order is out of range or not the archive's
+ */
+long generate_archive(int order, archive_t *archive, long count, int threads, unsigned long long seed);
+
+#endif
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT License
+/* overlay.h -- header of the pattern overlay engine for 9x9 puzzles
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <search.h>
+#include <puzzle.h>
+
+/* ways to place one number on a 9x9 grid, once in every row, col and chunk */
+#define OVERLAY_TEMPLATES 46656
+#define OVERLAY_SCALE 9
+#define OVERLAY_SIZE 81
+
+typedef struct overlay_level {
+    unsigned short *lists[OVERLAY_SCALE]; /* templates left to every number */
+    int counts[OVERLAY_SCALE]; /* count of templates left to every number */
+}overlay_level_t;
+
+typedef struct overlay {
+    overlay_level_t levels[OVERLAY_SCALE+1]; /* template lists of every depth, a number decided by depth */
+    unsigned short *pool; /* room of the lists of every depth */
+    long stride; /* room of the lists of one depth, as much as depth 0 takes */
+    int picks[OVERLAY_SCALE]; /* the template of every number decided, -1 if not yet */
+    cell_t map[OVERLAY_SIZE]; /* the solution */
+    long nodes; /* templates tried */
+    long narrows; /* lists filtered by overlaying the others */
+}overlay_t;
+
+/* the templates, bit i of a template is cell i in row-major order */
+const mask_t *overlay_templates();
+
+/* create an engine over a 9x9 puzzle; returns NULL if scale is not 9 */
+overlay_t *overlay_create(puzzle_t *puzzle);
+
+void overlay_free(overlay_t *overlay);
+
+/* search for a solution into map; returns 1 solved, 0 no solution */
+int overlay_run(overlay_t *overlay);
+
+#endif
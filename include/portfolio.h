@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT License
+/* portfolio.h -- header of racing search strategies on threads
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <puzzle.h>
+#include <task.h>
+
+/* guesses a member takes between checks for cancellation */
+#define PORTFOLIO_SLICE 256
+
+typedef struct portfolio_member {
+    task_t *task; /* the search of this strategy */
+    char name[64]; /* branching, value order, propagation, restart and backjump of the search */
+    int index; /* the place in members */
+    int cancelled; /* stopped because another member finished first */
+    double seconds; /* time run until finished or cancelled */
+    struct portfolio *portfolio; /* the race it is in */
+}portfolio_member_t;
+
+typedef struct portfolio {
+    int count; /* the count of members */
+    portfolio_member_t *members; /* one member for every thread */
+    long slice; /* guesses between checks for cancellation */
+    int done; /* set by the first member to finish */
+    int winner; /* the first member to finish, -1 if none */
+}portfolio_t;
+
+/* create count members over puzzle with strategies taken in turn from a built-in table
+ * member i is seeded by seed + i, and its search may be set up further before the race
+ * returns NULL if scale is too large
+ */
+portfolio_t *portfolio_create(puzzle_t *puzzle, int count, unsigned long long seed);
+
+/* free the portfolio and the searches of its members */
+void portfolio_free(portfolio_t *portfolio);
+
+/* race every member on its own thread, the first solution or proof of none cancels the rest
+ * returns TASK_SOLVED with the solution in the search of the winner, or TASK_UNSOLVABLE
+ */
+int portfolio_run(portfolio_t *portfolio);
+
+#endif
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MIT License
+/* profile.h -- header of the sampling profiler of solver stages
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/* stages a thread can be in */
+#define PROFILE_OTHER 0 /* outside any solver stage */
+#define PROFILE_VOID 1 /* step solver, scan every void for its numbers */
+#define PROFILE_NUMBER 2 /* step solver, scan every number for its places */
+#define PROFILE_FILL 3 /* step solver, fill the numbers found */
+#define PROFILE_VALIDATE 4 /* step solver, check the map */
+#define PROFILE_GUESS 5 /* guess a number on a void */
+#define PROFILE_DRAWBACK 6 /* withdraw a wrong guess */
+#define PROFILE_PROPAGATE 7 /* search, fill the singles */
+#define PROFILE_RENDER 8 /* draw a frame */
+#define PROFILE_STAGES 9
+
+/* deepest guess told apart, deeper ones are counted at it */
+#define PROFILE_DEPTH 4095
+
+/* most rows of a time series, two rows are merged into one when full */
+#define PROFILE_ROWS 4096
+
+/* most threads sampled at once, the ones attaching after them are not sampled */
+#define PROFILE_THREADS 256
+
+/* report formats */
+#define PROFILE_FOLDED 0 /* one line of stage and depth per stack with its samples, for flame graphs */
+#define PROFILE_SERIES 1 /* samples of every stage and mean depth over time */
+
+/* the stage and depth of the thread, read by the sampler on the same thread */
+extern __thread volatile int profile_where;
+
+/* tell the sampler the thread is in stage at depth guesses, costs one store */
+static inline void profile_mark(int stage, int depth)
+{
+    profile_where = (depth < PROFILE_DEPTH ? depth : PROFILE_DEPTH) << 4 | stage;
+}
+
+/* tell the sampler the thread is in stage at the depth marked last */
+static inline void profile_stage(int stage)
+{
+    profile_where = (profile_where & ~15) | stage;
+}
+
+/* sample the calling thread by the cpu time it spends, hz times a cpu second
+ * returns 0 if the timer can't be set
+ */
+int profile_start(int hz);
+
+/* sample the calling thread too until it detaches, for worker threads of the solvers
+ * returns 0 if not sampling, or no timer is left
+ */
+int profile_attach(void);
+
+/* stop sampling the calling thread, before it exits */
+void profile_detach(void);
+
+/* stop sampling and write the report of format to path; returns the count of samples, or -1 if not writable */
+long profile_stop(char *path, int format);
+
+/* the name of stage */
+const char *profile_name(int stage);
+
+/* samples of stage at any depth since the start */
+long profile_samples(int stage);
+
+#endif
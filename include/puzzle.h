@@ -7,11 +7,23 @@
 #ifndef PUZZLE_H
 #define PUZZLE_H
  
+/* a cell holds 0 for void or a number up to scale, one byte is enough up to scale 255
+ * build with -DPUZZLE_WIDE for two bytes, up to scale 65535
+ */
+#ifdef PUZZLE_WIDE
+typedef unsigned short cell_t;
+#else
+typedef unsigned char cell_t;
+#endif
+
+/* the largest number a cell holds */
+#define PUZZLE_CELLMAX ((1 << (8 * sizeof(cell_t))) - 1)
+
 typedef struct puzzle {
    int order; /* order N can be 2, 3, 4, ...， 10 */
    int scale; /* scale of number can be 2^2=4, 3^2=9, 4^2=16, ...， 10^2=100 */
    int size; /* size of puzzle can be 2^4=16, 3^4=81, 4^4=256, ..., 10^4=10000 */
-   int *map;
+   cell_t *map;
 }puzzle_t;
 
 /* make the world's hardest sudoku */
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT License
+/* render.h -- header of the buffered console renderer
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <puzzle.h>
+
+/* draw the whole map every frame */
+#define RENDER_FULL 0
+/* draw the cells changed since the last frame drawn */
+#define RENDER_DIFF 1
+
+typedef struct render {
+    int order; /* order of puzzle */
+    int scale; /* scale of number */
+    int size; /* size of puzzle */
+    int mode; /* full or diff */
+    long interval; /* least microseconds between frames, 0 for no limit */
+    char *buffer; /* reusable frame buffer */
+    int capacity; /* capacity of buffer */
+    cell_t *last; /* map of the last frame drawn */
+    int drawn; /* a frame has been drawn */
+    int pending; /* a frame was skipped after the last one drawn */
+    long lasttime; /* microseconds when the last frame was drawn */
+    long frames; /* frames drawn */
+    long skipped; /* frames skipped by the interval */
+}render_t;
+
+/* returns the buffer length needed to format a grid of order */
+int render_length(int order);
+
+/* format the grid with borders into text; returns the length */
+int render_grid(char *text, int order, cell_t *map);
+
+/* create a renderer for maps of puzzle */
+render_t *render_create(puzzle_t *puzzle, int mode, long interval);
+
+/* free the renderer and its buffers */
+void render_free(render_t *render);
+
+/* draw a frame of map with a single write unless the interval is not over; returns 1 if drawn */
+int render_frame(render_t *render, cell_t *map);
+
+/* draw the last skipped frame of map if any */
+void render_flush(render_t *render, cell_t *map);
+
+#endif
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT License
+/* sat.h -- header of the embedded CDCL solver
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef SAT_H
+#define SAT_H
+
+typedef struct sat_watch {
+    int cref; /* the clause watching */
+    int blocker; /* a literal of the clause, the clause is satisfied if it is true */
+}sat_watch_t;
+
+typedef struct sat_watches {
+    int count; /* the count of watches */
+    int capacity; /* the capacity of watches */
+    sat_watch_t *list; /* the watches */
+}sat_watches_t;
+
+typedef struct sat {
+    int totalvar; /* the total amount of variables */
+    int unsat; /* an empty clause is found */
+    /* clauses are kept in an arena as size, flags, lbd and literals */
+    int *arena; /* clause arena */
+    int arenasize; /* used length of arena */
+    int arenacap; /* capacity of arena */
+    int wasted; /* length of deleted clauses in arena */
+    int *learnts; /* refs of learnt clauses */
+    int totallearnt; /* the count of learnt clauses */
+    int learntcap; /* capacity of learnt refs */
+    int maxlearnt; /* learnt clauses to keep before reducing */
+    sat_watches_t *watches; /* watches of every literal */
+    /* assignment */
+    signed char *assigns; /* 1 true, -1 false, 0 unassigned of every variable */
+    signed char *phases; /* the last value of every variable */
+    int *levels; /* the decision level of every variable */
+    int *reasons; /* the clause implying every variable, -1 for decisions */
+    int *trail; /* literals in the order assigned */
+    int trailsize; /* the count of assigned literals */
+    int *trailhead; /* the start of every decision level in trail */
+    int level; /* the current decision level */
+    int qhead; /* the next literal to propagate */
+    /* vsids */
+    double *activity; /* activity of every variable */
+    double varinc; /* bump of activity */
+    int *heap; /* variables ordered by activity */
+    int heapsize; /* the count of variables in heap */
+    int *heapindex; /* position of every variable in heap, -1 if not in */
+    /* analysis */
+    char *seen; /* marks of variables */
+    int *learnt; /* buffer of the learnt clause and its removed literals */
+    /* statistics */
+    long decisions; /* count of decisions */
+    long propagations; /* count of propagated literals */
+    long conflicts; /* count of conflicts */
+    long restarts; /* count of restarts */
+}sat_t;
+
+/* create a solver of totalvar variables */
+sat_t *sat_create(int totalvar);
+
+/* free the solver */
+void sat_free(sat_t *sat);
+
+/* add a clause of dimacs literals before solving; returns 0 if the formula becomes unsat */
+int sat_add_clause(sat_t *sat, int *lits, int count);
+
+/* solve the formula; returns 1 sat or 0 unsat */
+int sat_solve(sat_t *sat);
+
+/* value of variable v (1-based) in the model, 1 true or 0 false */
+int sat_value(sat_t *sat, int v);
+
+#endif
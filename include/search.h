@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: MIT License
+/* search.h -- header of the quiet bitmask search engine
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <puzzle.h>
+
+/* set of numbers, bit n-1 stands for number n, so scale can be up to 128 */
+typedef unsigned __int128 mask_t;
+
+/* set of guess levels, bit g stands for the guess at depth g */
+typedef unsigned long long level_t;
+
+/* most decisions of a recorded nogood */
+#define SEARCH_NOGOOD 4
+/* most nogoods recorded */
+#define SEARCH_NOGOODS 4096
+
+/* branching policies */
+#define SEARCH_FIRST 0 /* the first void in row-major order */
+#define SEARCH_FEWEST 1 /* the void with the fewest candidates */
+#define SEARCH_WEIGHTED 2 /* the void with the fewest candidates per failure */
+
+/* value orders */
+#define SEARCH_NATURAL 0 /* numbers in ascending order */
+#define SEARCH_LCV 1 /* the least constraining number first */
+#define SEARCH_RANDOM 2 /* numbers shuffled by seed */
+
+/* propagation strengths */
+#define SEARCH_NAKED 0 /* naked singles only */
+#define SEARCH_HIDDEN 1 /* naked and hidden singles */
+#define SEARCH_MATCHING 2 /* singles, then every unit as all-different by matching once they are exhausted */
+
+/* restart policies */
+#define SEARCH_NEVER 0 /* run to the end */
+#define SEARCH_LUBY 1 /* restart after base guesses times 1, 1, 2, 1, 1, 2, 4, ... */
+#define SEARCH_GEOMETRIC 2 /* restart after base guesses times 1, growth, growth^2, ... */
+
+typedef struct search_guess {
+    int back; /* the back point in fills */
+    int cell; /* the location of guess */
+    int choice; /* the choice in nums */
+    int count; /* the count of noted numbers */
+    int *nums; /* the numbers in trying order */
+}search_guess_t;
+
+typedef struct search_ban {
+    int cell; /* the void */
+    int num; /* the number banned */
+    int stamp; /* totalfill when banned */
+}search_ban_t;
+
+typedef struct search_nogood {
+    int count; /* the count of decisions */
+    int cells[SEARCH_NOGOOD]; /* the cells of decisions */
+    int nums[SEARCH_NOGOOD]; /* the numbers of decisions */
+    int next[SEARCH_NOGOOD]; /* next slot holding the same decision, -1 for the end */
+}search_nogood_t;
+
+typedef struct search {
+    int order; /* order of puzzle */
+    int scale; /* scale of number */
+    int size; /* size of puzzle */
+    cell_t *map; /* working map, 0 for void */
+    mask_t full; /* every number in scale */
+    mask_t *units; /* numbers used in every row, col and chunk */
+    int *unitof; /* row, col and chunk of every cell */
+    int *members; /* cells of every row, col and chunk */
+    int *where; /* the cell holding every number of every unit, -1 if none */
+    int totalvoid; /* the total amount of voids */
+    int totalfill; /* the total amount of filled voids */
+    int guessed; /* depth of the guess stack */
+    int clashes; /* duplicated givens, no solution if any */
+    int stopped; /* stopped at a solution or a frontier node last run */
+    int *fills; /* fill history, the cells in filling order */
+    search_guess_t *guesses; /* guess stack */
+    long nodes; /* guesses tried, including the retried ones */
+    long drawbacks; /* times of withdrawn guesses */
+    /* conflict directed backjumping */
+    int backjump; /* 1 to jump back to the culprit guess, 0 for the last one */
+    int words; /* words of a level set */
+    level_t *deps; /* levels the fill of every cell depends on */
+    int *depwords; /* words used by deps of every cell */
+    level_t *confs; /* levels blamed for the withdrawn choices of every guess */
+    char *tainted; /* a solution was found under every guess, so its blame is not a nogood */
+    level_t *conflict; /* levels of the last contradiction */
+    long jumps; /* guesses skipped by backjumping */
+    /* nogoods */
+    mask_t *bans; /* numbers banned from every void by nogoods */
+    search_ban_t *banlog; /* ban history */
+    level_t *bandeps; /* levels every ban depends on */
+    int totalban; /* the count of bans in history */
+    int bancap; /* capacity of ban history */
+    search_nogood_t *nogoods; /* recorded nogoods */
+    int totalnogood; /* the count of recorded nogoods */
+    int *nogoodof; /* first slot of nogoods holding every number on every cell */
+    int checked; /* fills checked against nogoods */
+    long matchbans; /* numbers banned by all-different matching */
+    /* heuristics */
+    int branch; /* branching policy */
+    int value; /* value order */
+    int propagation; /* propagation strength */
+    unsigned long long seed; /* state of the random generator */
+    int restart; /* restart policy */
+    long restartbase; /* guesses of the first run */
+    double restartgrowth; /* growth of geometric restarts */
+    long restarts; /* times of restarts */
+    long restartnodes; /* nodes when the current run started */
+    long found; /* solutions or frontier nodes since reset, no restart after any */
+    int assumed; /* guesses made by assume at the bottom of stack, kept by restarts */
+    long *failures; /* contradictions met on every cell, kept across restarts */
+    int *phases; /* the last number guessed on every cell, tried first after restarts */
+    /* control */
+    long pause; /* the dive pauses before the next propagation once nodes reach it, 0 for never */
+}search_t;
+
+/* count the numbers in a mask */
+static inline int mask_count(mask_t mask)
+{
+    return __builtin_popcountll((unsigned long long)mask)
+        + __builtin_popcountll((unsigned long long)(mask >> 64));
+}
+
+/* the smallest number in a non-empty mask */
+static inline int mask_first(mask_t mask)
+{
+    unsigned long long low = (unsigned long long)mask;
+    return low ? __builtin_ctzll(low) + 1 : __builtin_ctzll((unsigned long long)(mask >> 64)) + 65;
+}
+
+/* the mask of a single number */
+static inline mask_t mask_of(int num)
+{
+    return (mask_t)1 << (num - 1);
+}
+
+/* create a search over the givens of puzzle; returns NULL if scale is too large */
+search_t *search_create(puzzle_t *puzzle);
+
+/* free the search and its buffers */
+void search_free(search_t *search);
+
+/* candidates of a void computed from its row, col, chunk and bans */
+static inline mask_t search_note(search_t *search, int cell)
+{
+    int *unit = search->unitof + 3 * cell;
+    return search->full & ~(search->units[unit[0]] | search->units[unit[1]] | search->units[unit[2]]
+        | search->bans[cell]);
+}
+
+/* put a given on a void at the root; returns 0 if it clashes with another given */
+int search_give(search_t *search, int cell, int num);
+
+/* take a given away at the root and make the cell void again, the nogoods are forgotten */
+void search_take(search_t *search, int cell);
+
+/* withdraw the fill history back to the back point */
+void search_undo(search_t *search, int back);
+
+/* withdraw every fill and guess, back to the givens */
+void search_reset(search_t *search);
+
+/* fill the naked and hidden singles until nothing changes; returns 0 on contradiction */
+int search_propagate(search_t *search);
+
+/* seed the random generator of value order */
+void search_seed(search_t *search, unsigned long long seed);
+
+/* copy backjumping, the heuristics and the seed of settings to search */
+void search_configure(search_t *search, search_t *settings);
+
+/* guess a void chosen by the branching policy, trying numbers in the value order */
+void search_guess(search_t *search);
+
+/* withdraw to the guess to blame and try its next choice; returns 0 if none is left */
+int search_drawback(search_t *search);
+
+/* guess a number on a void as a decision without other choices; returns 0 if not a candidate */
+int search_assume(search_t *search, int cell, int num);
+
+/* run the search to the next solution or the next node with depth guesses; returns 0 if exhausted
+ * or -1 if paused by the pause nodes, then the next call goes on from there
+ */
+int search_dive(search_t *search, int depth);
+
+/* run the search to the next solution; returns 1 solved, 0 no more solution or -1 paused */
+int search_run(search_t *search);
+
+/* rebuild a search over its givens from a saved map, fill history and guess stack
+ * the blame of withdrawn choices is not saved, so every restored fill depends on every level below
+ * returns 0 and resets the search if they don't fit the givens
+ */
+int search_restore(search_t *search, cell_t *map, int *fills, int totalfill, search_guess_t *guesses, int guessed);
+
+#endif
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: MIT License
+/* session.h -- header of the incremental solver session
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <puzzle.h>
+#include <search.h>
+
+typedef struct session {
+    search_t *search; /* candidate state of the givens, kept between calls */
+    cell_t *solution; /* the last solution found */
+    int solved; /* 1 solution still valid, 0 unknown, -1 no solution */
+    long nodes; /* guesses of the last search */
+}session_t;
+
+/* create a session over the givens of puzzle; returns NULL if scale is too large */
+session_t *session_create(puzzle_t *puzzle);
+
+/* free the session */
+void session_free(session_t *session);
+
+/* put a given on a cell, replacing the old one; returns 0 if out of range */
+int session_set(session_t *session, int row, int col, int num);
+
+/* make a cell void; returns 0 if out of range */
+int session_clear(session_t *session, int row, int col);
+
+/* revalidate the last solution or search again; returns 1 solvable or 0 not */
+int session_solve(session_t *session);
+
+#endif
@@ -8,8 +8,9 @@
 #define SOLVER_H
 
 #include <puzzle.h>
+#include <render.h>
 
-/* main procedure of solving method */
-void solver_main(puzzle_t *puzzle);
+/* main procedure of solving method, frames are drawn by render or in full if NULL */
+void solver_main(puzzle_t *puzzle, render_t *render);
 
 #endif
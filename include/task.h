@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT License
+/* task.h -- header of resumable solving tasks and their round robin
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <puzzle.h>
+#include <search.h>
+
+/* states of a task */
+#define TASK_RUNNING 0 /* more work to do */
+#define TASK_SOLVED 1 /* the solution is in search->map */
+#define TASK_UNSOLVABLE 2 /* proved to have no solution */
+
+typedef struct task {
+    search_t *search; /* the search, paused between steps */
+    int state; /* running, solved or unsolvable */
+    long steps; /* steps taken */
+    void *data; /* anything of the caller */
+}task_t;
+
+typedef struct schedule {
+    task_t **tasks; /* ring of running tasks */
+    int capacity; /* most tasks in the ring */
+    int head; /* the task to step next */
+    int count; /* the count of tasks in the ring */
+    long slice; /* guesses of every step, 0 to run to the end */
+}schedule_t;
+
+/* create a task over the givens of puzzle; returns NULL if scale is too large */
+task_t *task_create(puzzle_t *puzzle);
+
+/* free the task and its search */
+void task_free(task_t *task);
+
+/* run the task for at most maxnodes guesses, 0 for no limit; returns its state */
+int task_step(task_t *task, long maxnodes);
+
+/* create a round robin of at most capacity tasks, stepping each by slice guesses in turn */
+schedule_t *schedule_create(int capacity, long slice);
+
+/* free the round robin, the tasks left in it are not freed */
+void schedule_free(schedule_t *schedule);
+
+/* put a task at the end of the round; returns 0 if full */
+int schedule_add(schedule_t *schedule, task_t *task);
+
+/* step the task at the head; returns it if finished and taken out of the round, or NULL */
+task_t *schedule_next(schedule_t *schedule);
+
+#endif
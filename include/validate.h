@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: MIT License
+/* validate.h -- header of bulk grid validation
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#ifndef VALIDATE_H
+#define VALIDATE_H
+
+#include <puzzle.h>
+
+/* grids checked at once, one in every lane of a vector */
+#ifndef VALIDATE_LANES
+#define VALIDATE_LANES 16
+#endif
+
+/* results of validation */
+#define VALIDATE_OK 0 /* no number twice in a row, col or chunk */
+#define VALIDATE_CLASH 1 /* a number twice in a row, col or chunk */
+#define VALIDATE_RANGE 2 /* a number out of scale, or scale above 128 */
+#define VALIDATE_INCOMPLETE 3 /* a void in a grid asked to be complete */
+
+/* check a map of order, voids are allowed unless complete is 1; returns the result */
+int validate_map(cell_t *map, int order, int complete);
+
+/* check puzzles into results, 9x9 and 16x16 ones VALIDATE_LANES at a time and the others one by one
+ * returns the count of valid puzzles
+ */
+int validate_puzzles(puzzle_t **puzzles, int count, int complete, int *results);
+
+/* check count lines of compact format of lengths without the line end into results,
+ * 9x9 and 16x16 ones VALIDATE_LANES at a time straight from the text
+ * a line not of a fourth power length is out of range
+ * returns the count of valid lines
+ */
+int validate_compact(char **lines, int *lengths, int count, int complete, int *results);
+
+#endif
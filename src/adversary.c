@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: MIT License
+/* adversary.c -- the search for puzzles hard to the solver
+ * the tail latency of solving is made by the few puzzles whose clues lead the branching
+ * astray, and random puzzles seldom hit them. so the clues are searched for them instead,
+ * with the solver itself as the fitness: a climb thins a random grid to a puzzle whose
+ * clues can't lose any more, then swaps a clue for a void of the grid again and again,
+ * keeping every change which doesn't make the puzzle easier. a swap letting in another
+ * solution is mended by clues of the grid where the two solutions differ. as the clues
+ * always agree with the grid, every puzzle met has a solution.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <adversary.h>
+#include <generate.h>
+#include <search.h>
+#include <puzzle.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* xorshift64* generator */
+static unsigned long long adversary_random(unsigned long long *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+/* a random cell holding a clue if clue is 1, or a void if 0 */
+static int adversary_pick(adversary_t *adv, unsigned long long *state, cell_t *map, int clue)
+{
+    int cell;
+    do {
+        cell = adversary_random(state) % adv->size;
+    } while ((map[cell] != 0) != clue);
+    return cell;
+}
+
+adversary_t *adversary_create(int order, search_t *settings)
+{
+    generate_t *gen = generate_create(order);
+    if (gen == NULL) {
+        return NULL;
+    }
+
+    adversary_t *adv = malloc(sizeof(adversary_t));
+    adv->order = order;
+    adv->scale = gen->scale;
+    adv->size = gen->size;
+    adv->settings = settings;
+    adv->fitness = ADVERSARY_NODES;
+    adv->unique = 1;
+    adv->steps = 1000;
+    adv->limit = 1000000;
+    adv->evaluated = 0;
+    adv->gen = gen;
+    adv->grid = malloc(sizeof(cell_t) * adv->size);
+    adv->map = malloc(sizeof(cell_t) * adv->size);
+    adv->trial = malloc(sizeof(cell_t) * adv->size);
+    adv->best = malloc(sizeof(cell_t) * adv->size);
+    adv->score = -1;
+
+    return adv;
+}
+
+void adversary_free(adversary_t *adv)
+{
+    generate_free(adv->gen);
+    free(adv->grid);
+    free(adv->map);
+    free(adv->trial);
+    free(adv->best);
+    free(adv);
+}
+
+/* the fitness of a puzzle like adversary_score
+ * if it has another solution, differ is set to a cell where the two differ, from a random offset
+ */
+static double adversary_measure(adversary_t *adv, cell_t *map, int *differ, unsigned long long *state)
+{
+    puzzle_t puzzle = {adv->order, adv->scale, adv->size, map};
+    search_t *search = search_create(&puzzle);
+    struct timespec start, stop;
+    double score = -1;
+    int offset = state != NULL ? adversary_random(state) % adv->size : 0;
+
+    if (differ != NULL) {
+        *differ = -1;
+    }
+    search_configure(search, adv->settings);
+    search->pause = adv->limit;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int result = search_run(search);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (result != 0) {
+        if (adv->fitness == ADVERSARY_TIME) {
+            score = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+        }
+        else {
+            score = search->nodes;
+        }
+        /* the rest of the tree only tells whether another solution exists
+         * a puzzle reaching the limit is a killer already, and is taken unproved, and so is
+         * one whose proof reaches the limit again
+         */
+        if (adv->unique && result == 1) {
+            cell_t *first = malloc(sizeof(cell_t) * adv->size);
+            memcpy(first, search->map, sizeof(cell_t) * adv->size);
+            search->pause = adv->limit ? search->nodes + adv->limit : 0;
+            if (search_run(search) == 1) {
+                score = -1;
+                /* one of the two is not the grid */
+                cell_t *other = memcmp(first, adv->grid, sizeof(cell_t) * adv->size) ? first : search->map;
+                for (int i = 0; differ != NULL && i < adv->size; i++) {
+                    int cell = (offset + i) % adv->size;
+                    if (other[cell] != adv->grid[cell]) {
+                        *differ = cell;
+                        break;
+                    }
+                }
+            }
+            free(first);
+        }
+    }
+    search_free(search);
+    adv->evaluated++;
+
+    return score;
+}
+
+double adversary_score(adversary_t *adv, cell_t *map)
+{
+    return adversary_measure(adv, map, NULL, NULL);
+}
+
+double adversary_climb(adversary_t *adv, unsigned long long seed)
+{
+    unsigned long long state = seed ^ 0x9e3779b97f4a7c15ULL;
+    int *cells = malloc(sizeof(int) * adv->size);
+    int unique = adv->unique;
+
+    if (state == 0) {
+        state = 1;
+    }
+    generate_grid(adv->gen, seed, adv->grid);
+    memcpy(adv->map, adv->grid, sizeof(cell_t) * adv->size);
+
+    /* thin the grid in random order while the puzzle keeps one solution */
+    for (int i = 0; i < adv->size; i++) {
+        int j = adversary_random(&state) % (i + 1);
+        cells[i] = cells[j];
+        cells[j] = i;
+    }
+    adv->unique = 1;
+    for (int i = 0; i < adv->size; i++) {
+        adv->map[cells[i]] = 0;
+        if (adversary_score(adv, adv->map) < 0) {
+            adv->map[cells[i]] = adv->grid[cells[i]];
+        }
+    }
+    adv->unique = unique;
+    free(cells);
+
+    double score = adversary_score(adv, adv->map);
+    memcpy(adv->best, adv->map, sizeof(cell_t) * adv->size);
+    adv->score = score;
+
+    for (long s = 0; s < adv->steps; s++) {
+        memcpy(adv->trial, adv->map, sizeof(cell_t) * adv->size);
+        int clues = 0;
+        for (int i = 0; i < adv->size; i++) {
+            clues += adv->trial[i] != 0;
+        }
+        /* swap a clue for a void mostly, or drop it if not the last */
+        int clue = adversary_pick(adv, &state, adv->trial, 1);
+        int drop = clues > 1 && adversary_random(&state) % 4 == 0;
+        if (!drop) {
+            int cell = adversary_pick(adv, &state, adv->trial, 0);
+            adv->trial[cell] = adv->grid[cell];
+        }
+        adv->trial[clue] = 0;
+
+        /* a puzzle of more solutions is mended by the clue of a cell where they differ */
+        int differ;
+        double trial = adversary_measure(adv, adv->trial, &differ, &state);
+        while (trial < 0 && differ != -1) {
+            adv->trial[differ] = adv->grid[differ];
+            trial = adversary_measure(adv, adv->trial, &differ, &state);
+        }
+        /* ties are taken too, to walk along plateaus */
+        if (trial >= score) {
+            memcpy(adv->map, adv->trial, sizeof(cell_t) * adv->size);
+            score = trial;
+            if (score > adv->score) {
+                memcpy(adv->best, adv->map, sizeof(cell_t) * adv->size);
+                adv->score = score;
+            }
+        }
+    }
+
+    return adv->score;
+}
@@ -0,0 +1,397 @@
+// SPDX-License-Identifier: MIT License
+/* anneal.c -- the stochastic local search for large sparse puzzles
+ * on a large grid with few givens, backtracking may never come back from a wrong early
+ * guess. so every chunk is filled at random with the numbers its givens miss, which keeps
+ * chunks right, and then two free cells of a chunk are swapped at a time to bring down the
+ * numbers missing from rows and cols. a swap touches two rows and two cols at most, so its
+ * change of cost is read from the counts of numbers in them.
+ *
+ * swaps are accepted by simulated annealing: always if not worse, else by exp(-delta / T).
+ * T starts at the spread of the cost change of random swaps, falls by ANNEAL_COOLING after
+ * every round of as many swaps as pairs of free cells in a chunk, and is heated again once
+ * no round has made a new best for ANNEAL_STALL rounds. the search is incomplete: a chain
+ * may wander forever, and no answer proves nothing.
+ *
+ * a chain a few numbers short is handed to the exact search: its cells of numbers missing
+ * nowhere are kept, the rows and cols short of a number are voided, and the search fills
+ * them within a budget of guesses. chains run on threads from their own seeds, and the first
+ * solution, checked by the validator, stops the others.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <anneal.h>
+#include <validate.h>
+#include <search.h>
+#include <puzzle.h>
+#include <profile.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+/* swaps sampled for the spread of cost changes */
+#define ANNEAL_SAMPLES 200
+
+/* xorshift64*, one stream for every chain */
+static unsigned long long anneal_next(anneal_chain_t *chain)
+{
+    chain->state ^= chain->state >> 12;
+    chain->state ^= chain->state << 25;
+    chain->state ^= chain->state >> 27;
+    return chain->state * 0x2545f4914f6cdd1dULL;
+}
+
+static int anneal_below(anneal_chain_t *chain, int bound)
+{
+    return (int)((anneal_next(chain) >> 32) * bound >> 32);
+}
+
+/* fill the free cells of every chunk with the numbers its givens miss, shuffled */
+static void anneal_fill(anneal_chain_t *chain)
+{
+    anneal_t *anneal = chain->anneal;
+    int scale = anneal->scale;
+    int *nums = malloc(sizeof(int) * scale);
+    char *used = malloc(scale + 1);
+
+    for (int c = 0; c < scale; c++) {
+        int start = chain->starts[c], count = chain->starts[c+1] - start;
+        memset(used, 0, scale + 1);
+        for (int k = 0; k < scale; k++) {
+            int cell = scale * (c / anneal->order * anneal->order + k / anneal->order)
+                + c % anneal->order * anneal->order + k % anneal->order;
+            used[anneal->givens[cell]] = 1;
+        }
+        int left = 0;
+        for (int num = 1; num <= scale; num++) {
+            if (!used[num]) {
+                nums[left++] = num;
+            }
+        }
+        for (int k = count - 1; k > 0; k--) {
+            int j = anneal_below(chain, k + 1);
+            int temp = nums[k];
+            nums[k] = nums[j];
+            nums[j] = temp;
+        }
+        for (int k = 0; k < count; k++) {
+            chain->map[chain->frees[start+k]] = nums[k];
+        }
+    }
+    free(nums);
+    free(used);
+
+    memset(chain->rows, 0, sizeof(unsigned short) * scale * scale);
+    memset(chain->cols, 0, sizeof(unsigned short) * scale * scale);
+    for (int i = 0; i < anneal->size; i++) {
+        int num = chain->map[i] - 1;
+        chain->rows[scale*(i/scale)+num]++;
+        chain->cols[scale*(i%scale)+num]++;
+    }
+    chain->cost = 0;
+    for (int u = 0; u < scale * scale; u++) {
+        chain->cost += (chain->rows[u] == 0) + (chain->cols[u] == 0);
+    }
+    chain->best = chain->cost;
+}
+
+/* the change of cost by swapping cells a and b of one chunk */
+static int anneal_delta(anneal_chain_t *chain, int a, int b)
+{
+    int scale = chain->anneal->scale;
+    int x = chain->map[a] - 1, y = chain->map[b] - 1;
+    int ra = a / scale, ca = a % scale, rb = b / scale, cb = b % scale;
+    unsigned short *rows = chain->rows, *cols = chain->cols;
+    int delta = 0;
+
+    /* a unit losing its only x misses it, and a unit gaining a y it missed has it */
+    if (ra != rb) {
+        delta += (rows[scale*ra+x] == 1) - (rows[scale*ra+y] == 0);
+        delta += (rows[scale*rb+y] == 1) - (rows[scale*rb+x] == 0);
+    }
+    if (ca != cb) {
+        delta += (cols[scale*ca+x] == 1) - (cols[scale*ca+y] == 0);
+        delta += (cols[scale*cb+y] == 1) - (cols[scale*cb+x] == 0);
+    }
+    return delta;
+}
+
+static void anneal_swap(anneal_chain_t *chain, int a, int b, int delta)
+{
+    int scale = chain->anneal->scale;
+    int x = chain->map[a] - 1, y = chain->map[b] - 1;
+    int ra = a / scale, ca = a % scale, rb = b / scale, cb = b % scale;
+
+    chain->rows[scale*ra+x]--;
+    chain->rows[scale*ra+y]++;
+    chain->rows[scale*rb+y]--;
+    chain->rows[scale*rb+x]++;
+    chain->cols[scale*ca+x]--;
+    chain->cols[scale*ca+y]++;
+    chain->cols[scale*cb+y]--;
+    chain->cols[scale*cb+x]++;
+    chain->map[a] = y + 1;
+    chain->map[b] = x + 1;
+    chain->cost += delta;
+}
+
+/* two distinct free cells of a movable chunk */
+static void anneal_pick(anneal_chain_t *chain, int *a, int *b)
+{
+    int c = chain->movable[anneal_below(chain, chain->movables)];
+    int start = chain->starts[c], count = chain->starts[c+1] - start;
+    int i = anneal_below(chain, count);
+    int j = anneal_below(chain, count - 1);
+    *a = chain->frees[start+i];
+    *b = chain->frees[start+j+(j>=i)];
+}
+
+anneal_t *anneal_create(puzzle_t *puzzle, int count, unsigned long long seed)
+{
+    if (validate_map(puzzle->map, puzzle->order, 0) != VALIDATE_OK) {
+        return NULL;
+    }
+
+    anneal_t *anneal = malloc(sizeof(anneal_t));
+    int order = puzzle->order, scale = puzzle->scale, size = puzzle->size;
+    anneal->order = order;
+    anneal->scale = scale;
+    anneal->size = size;
+    anneal->givens = malloc(sizeof(cell_t) * size);
+    memcpy(anneal->givens, puzzle->map, sizeof(cell_t) * size);
+    anneal->count = count;
+    anneal->chains = malloc(sizeof(anneal_chain_t) * count);
+    anneal->seconds = 60;
+    anneal->handoff = 0;
+    anneal->budget = ANNEAL_BUDGET;
+    anneal->done = 0;
+    anneal->winner = -1;
+    anneal->solution = malloc(sizeof(cell_t) * size);
+
+    for (int i = 0; i < count; i++) {
+        anneal_chain_t *chain = anneal->chains + i;
+        chain->index = i;
+        chain->anneal = anneal;
+        chain->map = malloc(sizeof(cell_t) * size);
+        chain->fixed = malloc(size);
+        chain->frees = malloc(sizeof(int) * size);
+        chain->starts = malloc(sizeof(int) * (scale + 1));
+        chain->movable = malloc(sizeof(int) * scale);
+        chain->rows = malloc(sizeof(unsigned short) * scale * scale);
+        chain->cols = malloc(sizeof(unsigned short) * scale * scale);
+        chain->state = (seed + i) * 0x9e3779b97f4a7c15ULL ^ 0xd1b54a32d192ed03ULL;
+        if (chain->state == 0) {
+            chain->state = 1;
+        }
+
+        int used = 0;
+        chain->movables = 0;
+        for (int c = 0; c < scale; c++) {
+            chain->starts[c] = used;
+            for (int k = 0; k < scale; k++) {
+                int cell = scale * (c / order * order + k / order) + c % order * order + k % order;
+                chain->map[cell] = puzzle->map[cell];
+                chain->fixed[cell] = puzzle->map[cell] != 0;
+                if (!chain->fixed[cell]) {
+                    chain->frees[used++] = cell;
+                }
+            }
+            if (used - chain->starts[c] >= 2) {
+                chain->movable[chain->movables++] = c;
+            }
+        }
+        chain->starts[scale] = used;
+        anneal_fill(chain);
+        chain->moves = 0;
+        chain->rounds = 0;
+        chain->reheats = 0;
+        chain->handoffs = 0;
+        chain->finish = 0;
+        chain->seconds = 0;
+    }
+
+    return anneal;
+}
+
+void anneal_free(anneal_t *anneal)
+{
+    for (int i = 0; i < anneal->count; i++) {
+        anneal_chain_t *chain = anneal->chains + i;
+        free(chain->map);
+        free(chain->fixed);
+        free(chain->frees);
+        free(chain->starts);
+        free(chain->movable);
+        free(chain->rows);
+        free(chain->cols);
+    }
+    free(anneal->chains);
+    free(anneal->givens);
+    free(anneal->solution);
+    free(anneal);
+}
+
+/* hand the chain to the exact search with its rows and cols short of a number voided
+ * returns 1 with the solution in map of the chain
+ */
+static int anneal_handoff(anneal_chain_t *chain)
+{
+    anneal_t *anneal = chain->anneal;
+    int scale = anneal->scale;
+    cell_t *map = malloc(sizeof(cell_t) * anneal->size);
+    char *shortrow = calloc(scale, 1), *shortcol = calloc(scale, 1);
+    int solved = 0;
+
+    for (int u = 0; u < scale; u++) {
+        for (int num = 0; num < scale; num++) {
+            shortrow[u] |= chain->rows[scale*u+num] == 0;
+            shortcol[u] |= chain->cols[scale*u+num] == 0;
+        }
+    }
+    for (int i = 0; i < anneal->size; i++) {
+        int keep = chain->fixed[i] || (!shortrow[i/scale] && !shortcol[i%scale]);
+        map[i] = keep ? chain->map[i] : 0;
+    }
+
+    puzzle_t puzzle = {anneal->order, scale, anneal->size, map};
+    search_t *search = search_create(&puzzle);
+    if (search != NULL) {
+        search->pause = anneal->budget;
+        if (search_run(search) == 1) {
+            memcpy(chain->map, search->map, sizeof(cell_t) * anneal->size);
+            solved = 1;
+        }
+        search_free(search);
+    }
+    chain->handoffs++;
+
+    free(map);
+    free(shortrow);
+    free(shortcol);
+    return solved;
+}
+
+/* the spread of cost changes of random swaps, undone right after */
+static double anneal_spread(anneal_chain_t *chain)
+{
+    double sum = 0, square = 0;
+    int a, b;
+
+    if (chain->movables == 0) {
+        return 1;
+    }
+    for (int s = 0; s < ANNEAL_SAMPLES; s++) {
+        anneal_pick(chain, &a, &b);
+        int delta = anneal_delta(chain, a, b);
+        sum += delta;
+        square += (double)delta * delta;
+    }
+    double mean = sum / ANNEAL_SAMPLES;
+    double spread = sqrt(square / ANNEAL_SAMPLES - mean * mean);
+    return spread > 0 ? spread : 1;
+}
+
+/* anneal a chain until it solves, another chain has, or time is up */
+static void *anneal_worker(void *data)
+{
+    anneal_chain_t *chain = data;
+    anneal_t *anneal = chain->anneal;
+    struct timespec start, now;
+    long length = 0;
+    int handed = anneal->size, stall = 0;
+
+    profile_attach();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int c = 0; c < anneal->scale; c++) {
+        long count = chain->starts[c+1] - chain->starts[c];
+        length += count * count;
+    }
+    chain->hot = anneal_spread(chain);
+    chain->temperature = chain->hot;
+
+    while (chain->cost > 0 && chain->movables > 0) {
+        int best = chain->best;
+        for (long m = 0; m < length && chain->cost > 0; m++) {
+            int a, b;
+            anneal_pick(chain, &a, &b);
+            int delta = anneal_delta(chain, a, b);
+            if (delta <= 0 || (anneal_next(chain) >> 11) * 0x1.0p-53 < exp(-delta / chain->temperature)) {
+                anneal_swap(chain, a, b, delta);
+                if (chain->cost < chain->best) {
+                    chain->best = chain->cost;
+                }
+            }
+        }
+        chain->moves += length;
+        chain->rounds++;
+        chain->temperature *= ANNEAL_COOLING;
+        stall = chain->best < best ? 0 : stall + 1;
+        if (stall >= ANNEAL_STALL) {
+            chain->temperature = chain->hot;
+            chain->reheats++;
+            stall = 0;
+            handed = anneal->size;
+        }
+
+        /* a new low a few numbers short is worth a bounded exact search */
+        if (chain->cost > 0 && chain->cost <= anneal->handoff && chain->cost < handed) {
+            handed = chain->cost;
+            if (anneal_handoff(chain)) {
+                chain->cost = 0;
+                chain->best = 0;
+                chain->finish = 2;
+                break;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double seconds = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+        if (__atomic_load_n(&anneal->done, __ATOMIC_ACQUIRE) || seconds >= anneal->seconds) {
+            break;
+        }
+    }
+    if (chain->cost == 0 && chain->finish == 0) {
+        chain->finish = 1;
+    }
+
+    /* only a solution the validator passes with the givens kept may win */
+    int fits = chain->finish && validate_map(chain->map, anneal->order, 1) == VALIDATE_OK;
+    for (int i = 0; fits && i < anneal->size; i++) {
+        fits = anneal->givens[i] == 0 || anneal->givens[i] == chain->map[i];
+    }
+    if (fits) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&anneal->done, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            anneal->winner = chain->index;
+            memcpy(anneal->solution, chain->map, sizeof(cell_t) * anneal->size);
+        }
+    }
+    else {
+        chain->finish = 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    chain->seconds = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+    profile_detach();
+
+    return NULL;
+}
+
+int anneal_run(anneal_t *anneal)
+{
+    pthread_t *threads = malloc(sizeof(pthread_t) * anneal->count);
+
+    anneal->done = 0;
+    anneal->winner = -1;
+    for (int i = 0; i < anneal->count; i++) {
+        pthread_create(threads + i, NULL, anneal_worker, anneal->chains + i);
+    }
+    for (int i = 0; i < anneal->count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    return anneal->winner != -1;
+}
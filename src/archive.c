@@ -0,0 +1,564 @@
+// SPDX-License-Identifier: MIT License
+/* archive.c -- compact archives of solved grids
+ * a solved 9x9 grid is one of 6.67e21, so it takes 72.5 bits at least, yet a map spends
+ * 4 bytes on every cell. a grid is coded cell by cell in row order: every number is
+ * coded as its rank among the numbers left to the cell, and then placed and propagated
+ * by naked and hidden singles, the same on both sides, so a cell left with one number
+ * costs nothing. the ranks go through a range coder over uniform odds, which comes within
+ * a fraction of a bit of the product of the counts. a 9x9 grid takes 74 bits or so.
+ *
+ * grids are coded in blocks of ARCHIVE_BLOCK, and an index of blocks at the end of the
+ * file lets a block be read without the ones before it.
+ *
+ * layout in 64-bit words: magic, version, order, blocks, grids and the offset of the
+ * index as a header, then the blocks, then the offset and the count of grids of every block.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <archive.h>
+#include <validate.h>
+#include <search.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARCHIVE_MAGIC 0x52414b53
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_HEADER 6
+/* the range coder keeps its range above this */
+#define ARCHIVE_TOP (1U << 24)
+
+typedef struct archive_coder {
+    unsigned char *data; /* bytes written or read */
+    long at; /* next byte of data */
+    long length; /* bytes of data to read */
+    unsigned long long low; /* bottom of the range, with a carry above 32 bits */
+    unsigned range; /* width of the range */
+    unsigned code; /* value read less the bottom of the range */
+    unsigned char cache; /* the last byte held back for a carry */
+    long pending; /* bytes held back, the cache and a run of 0xff after it */
+    int started; /* the first byte, always 0, is dropped */
+}archive_coder_t;
+
+/* put out the top byte of low, holding back bytes a carry could still change */
+static void archive_shift(archive_coder_t *coder)
+{
+    if ((unsigned)coder->low < 0xff000000U || (coder->low >> 32) != 0) {
+        unsigned char carry = coder->low >> 32;
+        unsigned char temp = coder->cache;
+        do {
+            if (coder->started) {
+                coder->data[coder->at++] = temp + carry;
+            }
+            coder->started = 1;
+            temp = 0xff;
+        } while (--coder->pending != 0);
+        coder->cache = (coder->low >> 24) & 0xff;
+    }
+    coder->pending++;
+    coder->low = (coder->low & 0x00ffffffULL) << 8;
+}
+
+/* code rank among count equally likely ones */
+static void archive_put(archive_coder_t *coder, int rank, int count)
+{
+    unsigned r = coder->range / count;
+    coder->low += (unsigned long long)r * rank;
+    coder->range = r;
+    while (coder->range < ARCHIVE_TOP) {
+        coder->range <<= 8;
+        archive_shift(coder);
+    }
+}
+
+static void archive_flush(archive_coder_t *coder)
+{
+    for (int i = 0; i < 5; i++) {
+        archive_shift(coder);
+    }
+}
+
+static unsigned char archive_byte(archive_coder_t *coder)
+{
+    return coder->at < coder->length ? coder->data[coder->at++] : 0;
+}
+
+static void archive_start(archive_coder_t *coder, unsigned char *data, long length)
+{
+    coder->data = data;
+    coder->at = 0;
+    coder->length = length;
+    coder->low = 0;
+    coder->range = 0xffffffffU;
+    coder->code = 0;
+    coder->cache = 0;
+    coder->pending = 1;
+    coder->started = 0;
+    if (length >= 0) {
+        for (int i = 0; i < 4; i++) {
+            coder->code = coder->code << 8 | archive_byte(coder);
+        }
+    }
+}
+
+/* returns a rank among count, or -1 if the bytes are broken */
+static int archive_get(archive_coder_t *coder, int count)
+{
+    unsigned r = coder->range / count;
+    unsigned rank = coder->code / r;
+    if (rank >= (unsigned)count) {
+        return -1;
+    }
+    coder->code -= r * rank;
+    coder->range = r;
+    while (coder->range < ARCHIVE_TOP) {
+        coder->range <<= 8;
+        coder->code = coder->code << 8 | archive_byte(coder);
+    }
+    return rank;
+}
+
+archive_codec_t *archive_codec_create(int order)
+{
+    if (order < 2 || order > 11) {
+        return NULL;
+    }
+
+    archive_codec_t *codec = malloc(sizeof(archive_codec_t));
+    int scale = order * order, size = scale * scale;
+    codec->order = order;
+    codec->scale = scale;
+    codec->size = size;
+    codec->full = scale == 128 ? ~(mask_t)0 : ((mask_t)1 << scale) - 1;
+    codec->peercount = 3 * (scale - 1) - 2 * (order - 1);
+    codec->peers = malloc(sizeof(int) * size * codec->peercount);
+    codec->members = malloc(sizeof(int) * 3 * size);
+    codec->units = malloc(sizeof(int) * 3 * size);
+    codec->cands = malloc(sizeof(mask_t) * size);
+    codec->queue = malloc(sizeof(int) * size);
+    codec->places = malloc(3 * size);
+    codec->checks = malloc(sizeof(int) * 3 * size);
+
+    for (int i = 0; i < scale; i++) {
+        for (int j = 0; j < scale; j++) {
+            int cell = scale * i + j;
+            int chunk = i / order * order + j / order;
+            int k = i % order * order + j % order;
+            codec->members[scale*i+j] = cell;
+            codec->members[scale*(scale+j)+i] = cell;
+            codec->members[scale*(2*scale+chunk)+k] = cell;
+            codec->units[3*cell] = i;
+            codec->units[3*cell+1] = scale + j;
+            codec->units[3*cell+2] = 2 * scale + chunk;
+        }
+    }
+    for (int cell = 0; cell < size; cell++) {
+        int i = cell / scale, j = cell % scale;
+        int *peer = codec->peers + codec->peercount * cell;
+        int count = 0;
+        for (int other = 0; other < size; other++) {
+            int oi = other / scale, oj = other % scale;
+            int same = oi == i || oj == j || (oi / order == i / order && oj / order == j / order);
+            if (other != cell && same) {
+                peer[count++] = other;
+            }
+        }
+    }
+
+    return codec;
+}
+
+void archive_codec_free(archive_codec_t *codec)
+{
+    free(codec->peers);
+    free(codec->members);
+    free(codec->units);
+    free(codec->cands);
+    free(codec->queue);
+    free(codec->places);
+    free(codec->checks);
+    free(codec);
+}
+
+long archive_bound(archive_codec_t *codec, int count)
+{
+    int bits = 0;
+    while ((1 << bits) < codec->scale) {
+        bits++;
+    }
+    return (long)count * ((codec->size * bits + 7) / 8 + 1) + 8;
+}
+
+static void archive_clear(archive_codec_t *codec)
+{
+    for (int i = 0; i < codec->size; i++) {
+        codec->cands[i] = codec->full;
+    }
+    memset(codec->places, codec->scale, 3 * codec->size);
+}
+
+/* take nums from cell and count their places down in its units
+ * a number left with one place in a unit is queued to checks; returns 0 if left with none
+ */
+static int archive_remove(archive_codec_t *codec, int cell, mask_t nums, int *checked)
+{
+    int *unit = codec->units + 3 * cell;
+
+    codec->cands[cell] &= ~nums;
+    while (nums) {
+        int num = mask_first(nums);
+        nums &= nums - 1;
+        for (int k = 0; k < 3; k++) {
+            int at = codec->scale * unit[k] + num - 1;
+            int left = --codec->places[at];
+            if (left == 0) {
+                return 0;
+            }
+            if (left == 1) {
+                codec->checks[(*checked)++] = at;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* place bit at cell and propagate naked and hidden singles; returns 0 on a contradiction */
+static int archive_place(archive_codec_t *codec, int cell, mask_t bit)
+{
+    mask_t *cands = codec->cands;
+    int *queue = codec->queue;
+    int scale = codec->scale;
+    int head = 0, tail = 0, done = 0, checked = 0;
+
+    if (!archive_remove(codec, cell, cands[cell] & ~bit, &checked)) {
+        return 0;
+    }
+    queue[tail++] = cell;
+    while (head < tail || done < checked) {
+        /* naked: the peers of a cell with one number lose it */
+        while (head < tail) {
+            int x = queue[head++];
+            mask_t num = cands[x];
+            int *peer = codec->peers + codec->peercount * x;
+            for (int k = 0; k < codec->peercount; k++) {
+                int y = peer[k];
+                if (cands[y] & num) {
+                    if (!archive_remove(codec, y, num, &checked) || cands[y] == 0) {
+                        return 0;
+                    }
+                    if ((cands[y] & (cands[y] - 1)) == 0) {
+                        queue[tail++] = y;
+                    }
+                }
+            }
+        }
+
+        /* hidden: a number with one place in a unit goes there */
+        while (done < checked && head == tail) {
+            int at = codec->checks[done++];
+            int *member = codec->members + scale * (at / scale);
+            mask_t num = mask_of(at % scale + 1);
+            int y = -1;
+            for (int k = 0; k < scale; k++) {
+                if (cands[member[k]] & num) {
+                    y = member[k];
+                    break;
+                }
+            }
+            if (y == -1) {
+                return 0;
+            }
+            if (cands[y] != num) {
+                if (!archive_remove(codec, y, cands[y] & ~num, &checked)) {
+                    return 0;
+                }
+                queue[tail++] = y;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* code a grid; returns 0 if it is not a valid complete grid */
+static int archive_encode_grid(archive_codec_t *codec, archive_coder_t *coder, cell_t *map)
+{
+    mask_t *cands = codec->cands;
+
+    archive_clear(codec);
+    for (int cell = 0; cell < codec->size; cell++) {
+        int num = map[cell];
+        if (num < 1 || num > codec->scale) {
+            return 0;
+        }
+        mask_t bit = mask_of(num);
+        mask_t x = cands[cell];
+        if (!(x & bit)) {
+            return 0;
+        }
+        if (x & (x - 1)) {
+            archive_put(coder, mask_count(x & (bit - 1)), mask_count(x));
+            if (!archive_place(codec, cell, bit)) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* decode a grid; returns 0 if the bytes are broken */
+static int archive_decode_grid(archive_codec_t *codec, archive_coder_t *coder, cell_t *map)
+{
+    mask_t *cands = codec->cands;
+
+    archive_clear(codec);
+    for (int cell = 0; cell < codec->size; cell++) {
+        mask_t x = cands[cell];
+        if (x & (x - 1)) {
+            int rank = archive_get(coder, mask_count(x));
+            if (rank < 0) {
+                return 0;
+            }
+            for (int r = 0; r < rank; r++) {
+                x &= x - 1;
+            }
+            if (!archive_place(codec, cell, x & -x)) {
+                return 0;
+            }
+        }
+        map[cell] = mask_first(cands[cell]);
+    }
+
+    return 1;
+}
+
+long archive_encode(archive_codec_t *codec, cell_t *maps, int count, unsigned char *out)
+{
+    archive_coder_t coder;
+
+    archive_start(&coder, out, -1);
+    for (int k = 0; k < count; k++) {
+        if (!archive_encode_grid(codec, &coder, maps + (long)codec->size * k)) {
+            return -1 - k;
+        }
+    }
+    archive_flush(&coder);
+
+    return coder.at;
+}
+
+int archive_decode(archive_codec_t *codec, unsigned char *in, long length, int count, cell_t *maps)
+{
+    archive_coder_t coder;
+
+    archive_start(&coder, in, length);
+    for (int k = 0; k < count; k++) {
+        if (!archive_decode_grid(codec, &coder, maps + (long)codec->size * k)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* write the header, at the start of the file */
+static int archive_header(archive_t *archive)
+{
+    unsigned long long header[ARCHIVE_HEADER] = {
+        ARCHIVE_MAGIC, ARCHIVE_VERSION, archive->codec->order,
+        archive->blocks, archive->grids, archive->offsets[archive->blocks]
+    };
+
+    return fseek(archive->pf, 0, SEEK_SET) == 0
+        && fwrite(header, sizeof(header), 1, archive->pf) == 1;
+}
+
+/* make room for one more block */
+static void archive_grow(archive_t *archive)
+{
+    if (archive->blocks + 1 >= archive->capacity) {
+        archive->capacity *= 2;
+        archive->offsets = realloc(archive->offsets, sizeof(long) * archive->capacity);
+        archive->counts = realloc(archive->counts, sizeof(int) * archive->capacity);
+    }
+}
+
+static archive_t *archive_new(FILE *pf, int writing, archive_codec_t *codec, long capacity)
+{
+    archive_t *archive = malloc(sizeof(archive_t));
+    archive->pf = pf;
+    archive->writing = writing;
+    archive->codec = codec;
+    archive->blocks = 0;
+    archive->grids = 0;
+    archive->capacity = capacity;
+    archive->offsets = malloc(sizeof(long) * capacity);
+    archive->counts = malloc(sizeof(int) * capacity);
+    archive->offsets[0] = sizeof(unsigned long long) * ARCHIVE_HEADER;
+    archive->pending = malloc(sizeof(cell_t) * codec->size * ARCHIVE_BLOCK);
+    archive->waiting = 0;
+    archive->buffer = malloc(archive_bound(codec, ARCHIVE_BLOCK));
+
+    return archive;
+}
+
+static void archive_free(archive_t *archive)
+{
+    fclose(archive->pf);
+    archive_codec_free(archive->codec);
+    free(archive->offsets);
+    free(archive->counts);
+    free(archive->pending);
+    free(archive->buffer);
+    free(archive);
+}
+
+archive_t *archive_create(char *path, int order)
+{
+    archive_codec_t *codec = archive_codec_create(order);
+    if (codec == NULL) {
+        return NULL;
+    }
+    FILE *pf = fopen(path, "wb");
+    if (pf == NULL) {
+        archive_codec_free(codec);
+        return NULL;
+    }
+
+    archive_t *archive = archive_new(pf, 1, codec, 64);
+    /* a placeholder until the archive is closed */
+    if (!archive_header(archive)) {
+        archive_free(archive);
+        return NULL;
+    }
+
+    return archive;
+}
+
+archive_t *archive_open(char *path)
+{
+    FILE *pf = fopen(path, "rb");
+    if (pf == NULL) {
+        return NULL;
+    }
+    unsigned long long header[ARCHIVE_HEADER];
+    if (fread(header, sizeof(header), 1, pf) != 1 || header[0] != ARCHIVE_MAGIC
+        || header[1] != ARCHIVE_VERSION || header[3] > (1ULL << 40)) {
+        fclose(pf);
+        return NULL;
+    }
+    archive_codec_t *codec = archive_codec_create(header[2]);
+    if (codec == NULL) {
+        fclose(pf);
+        return NULL;
+    }
+
+    archive_t *archive = archive_new(pf, 0, codec, header[3] + 1);
+    archive->blocks = header[3];
+    archive->grids = header[4];
+    archive->offsets[archive->blocks] = header[5];
+
+    /* the index, and the largest block for the buffer */
+    int ok = fseek(pf, header[5], SEEK_SET) == 0;
+    long largest = 0;
+    for (long b = 0; ok && b < archive->blocks; b++) {
+        unsigned long long entry[2];
+        ok = fread(entry, sizeof(entry), 1, pf) == 1 && entry[1] <= ARCHIVE_BLOCK;
+        archive->offsets[b] = entry[0];
+        archive->counts[b] = entry[1];
+    }
+    for (long b = 0; ok && b < archive->blocks; b++) {
+        long length = archive->offsets[b+1] - archive->offsets[b];
+        ok = length >= 0;
+        largest = length > largest ? length : largest;
+    }
+    if (!ok) {
+        archive_free(archive);
+        return NULL;
+    }
+    free(archive->buffer);
+    archive->buffer = malloc(largest + 1);
+
+    return archive;
+}
+
+int archive_append(archive_t *archive, unsigned char *data, long length, int count)
+{
+    archive_grow(archive);
+    if (fwrite(data, 1, length, archive->pf) != (size_t)length) {
+        return 0;
+    }
+    archive->counts[archive->blocks] = count;
+    archive->offsets[archive->blocks+1] = archive->offsets[archive->blocks] + length;
+    archive->blocks++;
+    archive->grids += count;
+
+    return 1;
+}
+
+/* code and append the grids waiting */
+static int archive_drain(archive_t *archive)
+{
+    if (archive->waiting == 0) {
+        return 1;
+    }
+    long length = archive_encode(archive->codec, archive->pending, archive->waiting, archive->buffer);
+    int ok = length >= 0 && archive_append(archive, archive->buffer, length, archive->waiting);
+    archive->waiting = 0;
+
+    return ok;
+}
+
+int archive_write(archive_t *archive, cell_t *map)
+{
+    archive_codec_t *codec = archive->codec;
+    if (validate_map(map, codec->order, 1) != VALIDATE_OK) {
+        return 0;
+    }
+
+    memcpy(archive->pending + (long)codec->size * archive->waiting, map, sizeof(cell_t) * codec->size);
+    archive->waiting++;
+    if (archive->waiting == ARCHIVE_BLOCK) {
+        return archive_drain(archive);
+    }
+
+    return 1;
+}
+
+int archive_read(archive_t *archive, long block, cell_t *maps)
+{
+    if (block < 0 || block >= archive->blocks) {
+        return -1;
+    }
+    long length = archive->offsets[block+1] - archive->offsets[block];
+    if (fseek(archive->pf, archive->offsets[block], SEEK_SET) != 0
+        || fread(archive->buffer, 1, length, archive->pf) != (size_t)length) {
+        return -1;
+    }
+    if (!archive_decode(archive->codec, archive->buffer, length, archive->counts[block], maps)) {
+        return -1;
+    }
+
+    return archive->counts[block];
+}
+
+int archive_close(archive_t *archive)
+{
+    int ok = 1;
+
+    if (archive->writing) {
+        ok = archive_drain(archive);
+        for (long b = 0; ok && b < archive->blocks; b++) {
+            unsigned long long entry[2] = {archive->offsets[b], archive->counts[b]};
+            ok = fwrite(entry, sizeof(entry), 1, archive->pf) == 1;
+        }
+        ok = ok && archive_header(archive) && fflush(archive->pf) == 0;
+    }
+    archive_free(archive);
+
+    return ok;
+}
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: MIT License
+/* batch.c -- the lockstep batch solver for 9x9 puzzles
+ * most 9x9 puzzles fall to naked and hidden singles alone, and the work of one puzzle
+ * is too small to vectorize. so BATCH_LANES puzzles are packed into the lanes of a vector:
+ * every cell holds its candidates of every puzzle as 16-bit masks, and one pass over the
+ * 27 units propagates all of them at once. a lane which needs a guess drops out to the
+ * scalar search with what propagation has filled, and a lane with a contradiction stops.
+ *
+ * vectors are written with the gcc vector extension, so they become sse2 by default
+ * and wider registers with -march.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <batch.h>
+#include <search.h>
+#include <puzzle.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_SCALE 9
+#define BATCH_SIZE 81
+#define BATCH_FULL 0x1ff
+
+typedef unsigned short batch_vec_t __attribute__((vector_size(2 * BATCH_LANES)));
+
+/* members of every row, col and chunk */
+static int batch_members[3*BATCH_SCALE][BATCH_SCALE];
+static int batch_ready = 0;
+
+static void batch_init()
+{
+    for (int i = 0; i < BATCH_SCALE; i++) {
+        for (int j = 0; j < BATCH_SCALE; j++) {
+            batch_members[i][j] = BATCH_SCALE * i + j;
+            batch_members[BATCH_SCALE+i][j] = BATCH_SCALE * j + i;
+            batch_members[2*BATCH_SCALE+i][j] = BATCH_SCALE * (i / 3 * 3 + j / 3) + i % 3 * 3 + j % 3;
+        }
+    }
+    batch_ready = 1;
+}
+
+/* lanes holding a single candidate, all ones or zeros
+ * a macro, since passing wide vectors to functions depends on -march
+ */
+#define BATCH_SINGLE(x) ((batch_vec_t)(((x) & ((x) - 1)) == 0))
+
+/* returns 1 if any lane is not zero */
+static inline int batch_any(batch_vec_t *x)
+{
+    for (int l = 0; l < BATCH_LANES; l++) {
+        if ((*x)[l]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* propagate singles in every lane until nothing changes; returns the rounds
+ * bad lanes are set to non-zero on contradiction
+ */
+static int batch_propagate(batch_vec_t *cands, batch_vec_t *bad)
+{
+    const batch_vec_t full = (batch_vec_t){0} + BATCH_FULL;
+    batch_vec_t changed;
+    int rounds = 0;
+
+    do {
+        changed = (batch_vec_t){0};
+        rounds++;
+        for (int u = 0; u < 3 * BATCH_SCALE; u++) {
+            int *member = batch_members[u];
+            batch_vec_t seen = {0}, dup = {0}, once = {0}, twice = {0};
+
+            /* numbers placed and numbers having a place */
+            for (int k = 0; k < BATCH_SCALE; k++) {
+                batch_vec_t x = cands[member[k]];
+                batch_vec_t placed = x & BATCH_SINGLE(x);
+                dup |= seen & placed;
+                seen |= placed;
+                twice |= once & x;
+                once |= x;
+            }
+            *bad |= dup | (once ^ full);
+
+            /* the numbers with only one place which is not filled yet */
+            batch_vec_t hidden = once & ~twice & ~seen;
+            for (int k = 0; k < BATCH_SCALE; k++) {
+                batch_vec_t x = cands[member[k]];
+                batch_vec_t single = BATCH_SINGLE(x);
+                /* naked: the voids lose the placed numbers */
+                batch_vec_t y = (x & single) | (x & ~seen & ~single);
+                /* hidden: a void holding such a number keeps it only */
+                batch_vec_t only = (batch_vec_t)((y & hidden) != 0);
+                y = (y & hidden & only) | (y & ~only);
+                *bad |= (batch_vec_t)(y == 0);
+                changed |= x ^ y;
+                cands[member[k]] = y;
+            }
+        }
+        /* lanes gone bad may keep changing, they are ignored */
+        changed &= (batch_vec_t)(*bad == 0);
+    } while (batch_any(&changed));
+
+    return rounds;
+}
+
+/* solve one puzzle by the scalar search from map; returns 1 solved */
+static int batch_fallback(puzzle_t *puzzle, cell_t *map)
+{
+    cell_t *givens = puzzle->map;
+    puzzle->map = map;
+    search_t *search = search_create(puzzle);
+    puzzle->map = givens;
+    if (search == NULL) {
+        return 0;
+    }
+
+    int solved = search_run(search) == 1;
+    if (solved) {
+        memcpy(puzzle->map, search->map, sizeof(cell_t) * puzzle->size);
+    }
+    search_free(search);
+
+    return solved;
+}
+
+/* solve up to BATCH_LANES 9x9 puzzles in lockstep; returns the count solved */
+static int batch_lanes(puzzle_t **puzzles, int count, batch_stats_t *stats)
+{
+    batch_vec_t cands[BATCH_SIZE];
+    batch_vec_t bad = {0};
+    cell_t map[BATCH_SIZE];
+    int solved = 0;
+
+    /* unused lanes are left full, they never go bad */
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        cands[i] = (batch_vec_t){0} + BATCH_FULL;
+        for (int l = 0; l < count; l++) {
+            int num = puzzles[l]->map[i];
+            if (num >= 1 && num <= BATCH_SCALE) {
+                cands[i][l] = 1 << (num - 1);
+            }
+        }
+    }
+    stats->rounds += batch_propagate(cands, &bad);
+
+    for (int l = 0; l < count; l++) {
+        if (bad[l]) {
+            stats->unsolvable++;
+            continue;
+        }
+        int filled = 0;
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            unsigned x = cands[i][l];
+            map[i] = (x & (x - 1)) == 0 ? __builtin_ctz(x) + 1 : 0;
+            filled += map[i] != 0;
+        }
+        if (filled == BATCH_SIZE) {
+            memcpy(puzzles[l]->map, map, sizeof(map));
+            stats->propagated++;
+            solved++;
+        }
+        else {
+            /* a guess is needed, the lane drops out to the search */
+            stats->fallbacks++;
+            if (batch_fallback(puzzles[l], map)) {
+                solved++;
+            }
+            else {
+                stats->unsolvable++;
+            }
+        }
+    }
+
+    return solved;
+}
+
+int batch_solve(puzzle_t **puzzles, int count, batch_stats_t *stats)
+{
+    puzzle_t *lanes[BATCH_LANES];
+    int used = 0;
+    int solved = 0;
+
+    if (!batch_ready) {
+        batch_init();
+    }
+    for (int p = 0; p < count; p++) {
+        stats->puzzles++;
+        if (puzzles[p]->scale == BATCH_SCALE) {
+            lanes[used++] = puzzles[p];
+            if (used == BATCH_LANES) {
+                solved += batch_lanes(lanes, used, stats);
+                used = 0;
+            }
+        }
+        else {
+            stats->fallbacks++;
+            if (batch_fallback(puzzles[p], puzzles[p]->map)) {
+                solved++;
+            }
+            else {
+                stats->unsolvable++;
+            }
+        }
+    }
+    if (used > 0) {
+        solved += batch_lanes(lanes, used, stats);
+    }
+
+    return solved;
+}
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: MIT License
+/* checkpoint.c -- search checkpoints
+ * a checkpoint holds the working map, the fill history and the guess stack with the choice
+ * of every guess, so a search killed on the way can go on from exactly the same node.
+ * the search is copied to a buffer in a moment, and a thread writes it to a temporary file
+ * renamed over the last checkpoint, so the search doesn't wait and a crash never leaves half a file.
+ *
+ * layout in ints: magic, version, size, scale, totalfill, guessed, assumed, stopped,
+ * nodes, drawbacks, jumps, restarts, found and seed as pairs of low and high halves,
+ * map, fills, then back, cell, choice, count and nums of every guess.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <checkpoint.h>
+#include <search.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CHECKPOINT_MAGIC 0x504b4353
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_HEADER 20
+
+/* split a 64-bit value into two ints */
+static void checkpoint_put_long(int *text, unsigned long long value)
+{
+    text[0] = (int)(unsigned)(value & 0xffffffffULL);
+    text[1] = (int)(unsigned)(value >> 32);
+}
+
+static unsigned long long checkpoint_get_long(int *text)
+{
+    return (unsigned long long)(unsigned)text[0] | (unsigned long long)(unsigned)text[1] << 32;
+}
+
+checkpoint_t *checkpoint_create(char *path, search_t *search)
+{
+    checkpoint_t *checkpoint = malloc(sizeof(checkpoint_t));
+    checkpoint->path = strdup(path);
+    checkpoint->temp = malloc(strlen(path) + 5);
+    sprintf(checkpoint->temp, "%s.tmp", path);
+    checkpoint->capacity = CHECKPOINT_HEADER + 6 * search->size;
+    checkpoint->buffer = malloc(sizeof(int) * checkpoint->capacity);
+    checkpoint->length = 0;
+    checkpoint->started = 0;
+    checkpoint->busy = 0;
+    checkpoint->failed = 0;
+    checkpoint->written = 0;
+    checkpoint->skipped = 0;
+
+    return checkpoint;
+}
+
+void checkpoint_free(checkpoint_t *checkpoint)
+{
+    checkpoint_wait(checkpoint);
+    free(checkpoint->path);
+    free(checkpoint->temp);
+    free(checkpoint->buffer);
+    free(checkpoint);
+}
+
+/* write the buffer to the temporary file and rename it over the checkpoint */
+static void *checkpoint_writer(void *data)
+{
+    checkpoint_t *checkpoint = data;
+    int failed = 1;
+
+    FILE *pf = fopen(checkpoint->temp, "wb");
+    if (pf != NULL) {
+        failed = fwrite(checkpoint->buffer, sizeof(int), checkpoint->length, pf) != (size_t)checkpoint->length;
+        failed |= fflush(pf) != 0 || fsync(fileno(pf)) != 0;
+        failed |= fclose(pf) != 0;
+        if (!failed) {
+            failed = rename(checkpoint->temp, checkpoint->path) != 0;
+        }
+    }
+
+    checkpoint->failed = failed;
+    if (!failed) {
+        checkpoint->written++;
+    }
+    __atomic_store_n(&checkpoint->busy, 0, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+int checkpoint_save(checkpoint_t *checkpoint, search_t *search)
+{
+    if (__atomic_load_n(&checkpoint->busy, __ATOMIC_ACQUIRE)) {
+        checkpoint->skipped++;
+        return 0;
+    }
+    checkpoint_wait(checkpoint);
+
+    /* the guesses take their numbers beyond the fixed part */
+    int need = CHECKPOINT_HEADER + search->size + search->totalfill + 4 * search->guessed;
+    for (int g = 0; g < search->guessed; g++) {
+        need += search->guesses[g].count;
+    }
+    if (need > checkpoint->capacity) {
+        checkpoint->capacity = need;
+        checkpoint->buffer = realloc(checkpoint->buffer, sizeof(int) * need);
+    }
+
+    int *text = checkpoint->buffer;
+    text[0] = CHECKPOINT_MAGIC;
+    text[1] = CHECKPOINT_VERSION;
+    text[2] = search->size;
+    text[3] = search->scale;
+    text[4] = search->totalfill;
+    text[5] = search->guessed;
+    text[6] = search->assumed;
+    text[7] = search->stopped;
+    checkpoint_put_long(text + 8, search->nodes);
+    checkpoint_put_long(text + 10, search->drawbacks);
+    checkpoint_put_long(text + 12, search->jumps);
+    checkpoint_put_long(text + 14, search->restarts);
+    checkpoint_put_long(text + 16, search->found);
+    checkpoint_put_long(text + 18, search->seed);
+    int length = CHECKPOINT_HEADER;
+    /* cells are widened to the words of the file */
+    for (int i = 0; i < search->size; i++) {
+        text[length+i] = search->map[i];
+    }
+    length += search->size;
+    memcpy(text + length, search->fills, sizeof(int) * search->totalfill);
+    length += search->totalfill;
+    for (int g = 0; g < search->guessed; g++) {
+        search_guess_t *guess = search->guesses + g;
+        text[length++] = guess->back;
+        text[length++] = guess->cell;
+        text[length++] = guess->choice;
+        text[length++] = guess->count;
+        memcpy(text + length, guess->nums, sizeof(int) * guess->count);
+        length += guess->count;
+    }
+    checkpoint->length = length;
+
+    __atomic_store_n(&checkpoint->busy, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&checkpoint->writer, NULL, checkpoint_writer, checkpoint) != 0) {
+        /* no thread, write it here */
+        checkpoint_writer(checkpoint);
+        return !checkpoint->failed;
+    }
+    checkpoint->started = 1;
+
+    return 1;
+}
+
+int checkpoint_wait(checkpoint_t *checkpoint)
+{
+    if (checkpoint->started) {
+        pthread_join(checkpoint->writer, NULL);
+        checkpoint->started = 0;
+    }
+    return !checkpoint->failed;
+}
+
+int checkpoint_load(char *path, search_t *search)
+{
+    FILE *pf = fopen(path, "rb");
+    if (pf == NULL) {
+        return 0;
+    }
+    fseek(pf, 0, SEEK_END);
+    long length = ftell(pf) / sizeof(int);
+    fseek(pf, 0, SEEK_SET);
+    if (length < CHECKPOINT_HEADER) {
+        fclose(pf);
+        return 0;
+    }
+    int *text = malloc(sizeof(int) * length);
+    int ok = fread(text, sizeof(int), length, pf) == (size_t)length;
+    fclose(pf);
+
+    int totalfill = text[4], guessed = text[5];
+    ok = ok && text[0] == CHECKPOINT_MAGIC && text[1] == CHECKPOINT_VERSION
+        && text[2] == search->size && text[3] == search->scale
+        && totalfill >= 0 && totalfill <= search->size && guessed >= 0 && guessed <= totalfill
+        && CHECKPOINT_HEADER + search->size + totalfill + 4L * guessed <= length;
+
+    /* point the saved guesses at their numbers in text */
+    search_guess_t *guesses = malloc(sizeof(search_guess_t) * (guessed > 0 ? guessed : 1));
+    long at = CHECKPOINT_HEADER + search->size + totalfill;
+    for (int g = 0; ok && g < guessed; g++) {
+        if (at + 4 > length || at + 4 + text[at+3] > length || text[at+3] < 1) {
+            ok = 0;
+            break;
+        }
+        guesses[g].back = text[at];
+        guesses[g].cell = text[at+1];
+        guesses[g].choice = text[at+2];
+        guesses[g].count = text[at+3];
+        guesses[g].nums = text + at + 4;
+        at += 4 + text[at+3];
+    }
+
+    cell_t *map = malloc(sizeof(cell_t) * search->size);
+    for (int i = 0; ok && i < search->size; i++) {
+        int num = text[CHECKPOINT_HEADER+i];
+        ok = num >= 0 && num <= search->scale;
+        map[i] = num;
+    }
+    ok = ok && search_restore(search, map,
+        text + CHECKPOINT_HEADER + search->size, totalfill, guesses, guessed);
+    free(map);
+    if (ok) {
+        search->assumed = text[6] < guessed ? text[6] : guessed;
+        search->stopped = text[7];
+        search->nodes = checkpoint_get_long(text + 8);
+        search->drawbacks = checkpoint_get_long(text + 10);
+        search->jumps = checkpoint_get_long(text + 12);
+        search->restarts = checkpoint_get_long(text + 14);
+        search->found = checkpoint_get_long(text + 16);
+        search->seed = checkpoint_get_long(text + 18);
+        search->restartnodes = search->nodes;
+    }
+
+    free(guesses);
+    free(text);
+    return ok;
+}
@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: MIT License
+/* cnf.c -- the cnf encoding of sudoku
+ * variable x(cell, n) is true if number n is filled in cell. the givens are applied while
+ * encoding, so no variable is made for a given cell or a number already in its row, col or
+ * chunk. every cell and every number of a unit makes an exactly-one constraint, at-most-one
+ * is pairwise for small groups and a sequential counter for large ones.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <cnf.h>
+#include <sat.h>
+#include <puzzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CNF_PAIRWISE 6 /* largest group encoded pairwise */
+
+static void cnf_clause(cnf_t *cnf, int *lits, int count)
+{
+    if (cnf->length + count + 1 > cnf->capacity) {
+        while (cnf->length + count + 1 > cnf->capacity) {
+            cnf->capacity *= 2;
+        }
+        cnf->lits = realloc(cnf->lits, sizeof(int) * cnf->capacity);
+    }
+    for (int i = 0; i < count; i++) {
+        cnf->lits[cnf->length++] = lits[i];
+    }
+    cnf->lits[cnf->length++] = 0;
+    cnf->totalclause++;
+}
+
+static void cnf_exactly_one(cnf_t *cnf, int *vars, int count)
+{
+    int clause[3];
+
+    /* at least one */
+    cnf_clause(cnf, vars, count);
+
+    /* at most one */
+    if (count <= CNF_PAIRWISE) {
+        for (int a = 0; a < count; a++) {
+            for (int b = a + 1; b < count; b++) {
+                clause[0] = -vars[a];
+                clause[1] = -vars[b];
+                cnf_clause(cnf, clause, 2);
+            }
+        }
+        return;
+    }
+    /* sequential counter, s(i) is true if one of the first i+1 variables is true */
+    int s = cnf->totalvar;
+    cnf->totalvar += count - 1;
+    for (int i = 0; i < count - 1; i++) {
+        clause[0] = -vars[i];
+        clause[1] = s + i + 1;
+        cnf_clause(cnf, clause, 2);
+        if (i > 0) {
+            clause[0] = -(s + i);
+            clause[1] = s + i + 1;
+            cnf_clause(cnf, clause, 2);
+            clause[0] = -vars[i];
+            clause[1] = -(s + i);
+            cnf_clause(cnf, clause, 2);
+        }
+    }
+    clause[0] = -vars[count-1];
+    clause[1] = -(s + count - 1);
+    cnf_clause(cnf, clause, 2);
+}
+
+cnf_t *cnf_encode(puzzle_t *puzzle)
+{
+    int puzzle_order = puzzle->order;
+    int puzzle_scale = puzzle->scale;
+    int puzzle_size = puzzle->size;
+    cell_t *puzzle_map = puzzle->map;
+
+    cnf_t *cnf = malloc(sizeof(cnf_t));
+    cnf->order = puzzle_order;
+    cnf->scale = puzzle_scale;
+    cnf->size = puzzle_size;
+    cnf->map = malloc(sizeof(cell_t) * puzzle_size);
+    memcpy(cnf->map, puzzle_map, sizeof(cell_t) * puzzle_size);
+    cnf->vars = calloc(puzzle_size * puzzle_scale, sizeof(int));
+    cnf->totalvar = 0;
+    cnf->totalclause = 0;
+    cnf->capacity = 1024;
+    cnf->length = 0;
+    cnf->lits = malloc(sizeof(int) * cnf->capacity);
+
+    /* numbers given in every row, col and chunk, counted for duplication */
+    int *given = calloc(3 * puzzle_scale * puzzle_scale, sizeof(int));
+    int clash = 0;
+    for (int i = 0; i < puzzle_scale; i++) {
+        for (int j = 0; j < puzzle_scale; j++) {
+            int num = puzzle_map[puzzle_scale*i+j];
+            if (num < 1 || num > puzzle_scale) {
+                continue;
+            }
+            int chunk = (i / puzzle_order) * puzzle_order + j / puzzle_order;
+            clash |= given[puzzle_scale*i+num-1]++;
+            clash |= given[puzzle_scale*(puzzle_scale+j)+num-1]++;
+            clash |= given[puzzle_scale*(2*puzzle_scale+chunk)+num-1]++;
+        }
+    }
+
+    /* variables of the candidates */
+    for (int i = 0; i < puzzle_scale; i++) {
+        for (int j = 0; j < puzzle_scale; j++) {
+            int cell = puzzle_scale * i + j;
+            int chunk = (i / puzzle_order) * puzzle_order + j / puzzle_order;
+            if (puzzle_map[cell] >= 1 && puzzle_map[cell] <= puzzle_scale) {
+                continue;
+            }
+            for (int n = 1; n <= puzzle_scale; n++) {
+                if (!given[puzzle_scale*i+n-1] && !given[puzzle_scale*(puzzle_scale+j)+n-1]
+                    && !given[puzzle_scale*(2*puzzle_scale+chunk)+n-1]) {
+                    cnf->vars[puzzle_scale*cell+n-1] = ++cnf->totalvar;
+                }
+            }
+        }
+    }
+
+    if (clash) {
+        /* duplicated givens, the empty clause */
+        cnf_clause(cnf, NULL, 0);
+        free(given);
+        return cnf;
+    }
+
+    int *group = malloc(sizeof(int) * puzzle_scale);
+    int count;
+    /* every void takes exactly one number */
+    for (int cell = 0; cell < puzzle_size; cell++) {
+        if (puzzle_map[cell] >= 1 && puzzle_map[cell] <= puzzle_scale) {
+            continue;
+        }
+        count = 0;
+        for (int n = 1; n <= puzzle_scale; n++) {
+            if (cnf->vars[puzzle_scale*cell+n-1]) {
+                group[count++] = cnf->vars[puzzle_scale*cell+n-1];
+            }
+        }
+        cnf_exactly_one(cnf, group, count);
+    }
+    /* every missing number takes exactly one void in every row, col and chunk */
+    for (int u = 0; u < 3 * puzzle_scale; u++) {
+        for (int n = 1; n <= puzzle_scale; n++) {
+            if (given[puzzle_scale*u+n-1]) {
+                continue;
+            }
+            count = 0;
+            for (int k = 0; k < puzzle_scale; k++) {
+                int i, j;
+                if (u < puzzle_scale) {
+                    i = u;
+                    j = k;
+                }
+                else if (u < 2 * puzzle_scale) {
+                    i = k;
+                    j = u - puzzle_scale;
+                }
+                else {
+                    int chunk = u - 2 * puzzle_scale;
+                    i = (chunk / puzzle_order) * puzzle_order + k / puzzle_order;
+                    j = (chunk % puzzle_order) * puzzle_order + k % puzzle_order;
+                }
+                int var = cnf->vars[puzzle_scale*(puzzle_scale*i+j)+n-1];
+                if (var) {
+                    group[count++] = var;
+                }
+            }
+            cnf_exactly_one(cnf, group, count);
+        }
+    }
+    free(group);
+    free(given);
+
+    return cnf;
+}
+
+void cnf_free(cnf_t *cnf)
+{
+    free(cnf->map);
+    free(cnf->vars);
+    free(cnf->lits);
+    free(cnf);
+}
+
+int cnf_write_dimacs(char *path, cnf_t *cnf)
+{
+    FILE *pf;
+    int state = 0;
+
+    pf = fopen(path, "w");
+    if (pf != NULL) {
+        state = fprintf(pf, "c sudoku of order %d, x(cell, n) = vars[scale*cell+n-1]\n", cnf->order) > 0;
+        state &= fprintf(pf, "p cnf %d %d\n", cnf->totalvar, cnf->totalclause) > 0;
+        for (int i = 0; i < cnf->length && state; i++) {
+            state = fprintf(pf, cnf->lits[i] == 0 ? "0\n" : "%d ", cnf->lits[i]) > 0;
+        }
+        state *= fclose(pf) + 1;
+    }
+
+    return state;
+}
+
+sat_t *cnf_load(cnf_t *cnf)
+{
+    sat_t *sat = sat_create(cnf->totalvar);
+    int start = 0;
+
+    for (int i = 0; i < cnf->length; i++) {
+        if (cnf->lits[i] == 0) {
+            sat_add_clause(sat, cnf->lits + start, i - start);
+            start = i + 1;
+        }
+    }
+
+    return sat;
+}
+
+void cnf_decode(cnf_t *cnf, sat_t *sat, cell_t *map)
+{
+    for (int cell = 0; cell < cnf->size; cell++) {
+        map[cell] = cnf->map[cell];
+        for (int n = 1; n <= cnf->scale; n++) {
+            int var = cnf->vars[cnf->scale*cell+n-1];
+            if (var && sat_value(sat, var)) {
+                map[cell] = n;
+            }
+        }
+    }
+}
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT License
+/* corpus.c -- text formats for streams of puzzles
+ * a corpus holds one map per line, so it can be streamed, split and concatenated by line.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <corpus.h>
+
+#include <string.h>
+
+/* symbols of numbers 1, 2, 3, ... in compact format */
+static const char symbols[] =
+    "123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz!#$%&()*+,-/:;<=>?@[]^_{|}~";
+
+/* the number of every symbol in compact format, 0 for void and -1 for none, built on first use */
+static signed char numbers[256];
+static int numbered = 0;
+
+static void corpus_number()
+{
+    memset(numbers, -1, sizeof(numbers));
+    numbers['.'] = 0;
+    numbers['0'] = 0;
+    for (int i = 0; symbols[i] != '\0'; i++) {
+        numbers[(unsigned char)symbols[i]] = i + 1;
+    }
+    numbered = 1;
+}
+
+const signed char *corpus_numbers()
+{
+    if (!numbered) {
+        corpus_number();
+    }
+    return numbers;
+}
+
+int corpus_format(char *name)
+{
+    if (!strcmp(name, "line")) {
+        return CORPUS_LINE;
+    }
+    else if (!strcmp(name, "compact")) {
+        return CORPUS_COMPACT;
+    }
+
+    return -1;
+}
+
+int corpus_length(int format, int size)
+{
+    /* numbers take at most 3 digits and a space */
+    return format == CORPUS_COMPACT ? size + 2 : 4 * size + 2;
+}
+
+int corpus_print(char *text, int format, cell_t *map, int scale, int size)
+{
+    int length = 0;
+    int num;
+
+    if (format == CORPUS_COMPACT) {
+        if (scale > (int)sizeof(symbols) - 1) {
+            return 0;
+        }
+        for (int i = 0; i < size; i++) {
+            text[length++] = map[i] != 0 ? symbols[map[i]-1] : '.';
+        }
+    }
+    else {
+        if (scale > 999) {
+            return 0;
+        }
+        for (int i = 0; i < size; i++) {
+            num = map[i];
+            if (i != 0) {
+                text[length++] = ' ';
+            }
+            if (num >= 100) {
+                text[length++] = '0' + num / 100;
+            }
+            if (num >= 10) {
+                text[length++] = '0' + num / 10 % 10;
+            }
+            text[length++] = '0' + num % 10;
+        }
+    }
+    text[length++] = '\n';
+    text[length] = '\0';
+
+    return length;
+}
+
+int corpus_parse(char *text, int format, cell_t *map, int capacity)
+{
+    int count = 0;
+
+    if (format == CORPUS_COMPACT) {
+        if (!numbered) {
+            corpus_number();
+        }
+        for (; *text != '\0' && *text != '\n' && *text != '\r'; text++) {
+            if (count == capacity) {
+                return -1;
+            }
+            int num = numbers[(unsigned char)*text];
+            if (num == -1) {
+                return -1;
+            }
+            map[count++] = num;
+        }
+    }
+    else {
+        while (1) {
+            while (*text == ' ' || *text == '\t') {
+                text++;
+            }
+            if (*text < '0' || *text > '9') {
+                break;
+            }
+            if (count == capacity) {
+                return -1;
+            }
+            int num = 0;
+            while (*text >= '0' && *text <= '9') {
+                num = 10 * num + *text++ - '0';
+                /* a number no cell holds */
+                if (num > PUZZLE_CELLMAX) {
+                    return -1;
+                }
+            }
+            map[count++] = num;
+        }
+        if (*text != '\0' && *text != '\n' && *text != '\r') {
+            return -1;
+        }
+    }
+
+    return count;
+}
+
+int corpus_order(int size)
+{
+    for (int order = 1; order * order * order * order <= size; order++) {
+        if (order * order * order * order == size) {
+            return order;
+        }
+    }
+    return 0;
+}
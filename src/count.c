@@ -0,0 +1,486 @@
+// SPDX-License-Identifier: MIT License
+/* count.c -- exact counting of completions
+ * the search counts completions one by one, so sparse grids with billions of them take days.
+ * here the grid is filled a row at a time instead. what the rows left can hold only depends
+ * on the numbers every col has used and the numbers every chunk of the unfinished band has
+ * used, so partial grids of the same masks are one state, kept with the count of partial
+ * grids reaching it. every state is extended by every way to fill the next row.
+ *
+ * states also merge up to the symmetries keeping the givens of the rows left: the numbers
+ * not given below are relabeled, the cols without givens below are swapped within their
+ * stack, and the stacks without givens below are swapped. a state is made canonical by
+ * sorting those numbers by the cols and chunks holding them, then those cols and stacks by
+ * their masks, a few rounds until nothing moves. that only applies symmetries, so it never
+ * merges states of different counts, though equal ones may be left apart now and then.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <count.h>
+#include <search.h>
+#include <puzzle.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct count_table {
+    int width; /* masks of a state, every col then every chunk of the band */
+    long used; /* states kept */
+    long capacity; /* slots, a power of 2 kept twice the states at least */
+    long *slots; /* index of the state in every slot, -1 for empty */
+    mask_t *keys; /* masks of every state */
+    count_total_t *totals; /* partial grids reaching every state */
+}count_table_t;
+
+typedef struct count_walk {
+    int order; /* order of puzzle */
+    int scale; /* scale of number */
+    cell_t *map; /* the givens */
+    mask_t full; /* every number in scale */
+    int row; /* the row being filled */
+    int last; /* the row ends its band */
+    mask_t *cols; /* numbers used in every col */
+    mask_t *chunks; /* numbers used in every chunk of the band */
+    mask_t *bans; /* numbers given in the row, or below in the col or chunk, of every void of the row */
+    mask_t freenums; /* numbers given in no row below */
+    char *freecols; /* cols without givens below */
+    char *freestacks; /* stacks without givens below */
+    mask_t *state; /* the state after the row */
+    count_total_t weight; /* partial grids reaching the state being extended */
+    count_table_t *next; /* states after the row */
+    count_t *count;
+}count_walk_t;
+
+count_t *count_create(puzzle_t *puzzle)
+{
+    if (puzzle->scale > 128) {
+        return NULL;
+    }
+
+    count_t *count = malloc(sizeof(count_t));
+    count->puzzle = puzzle;
+    count->limit = COUNT_STATES;
+    count->total = 0;
+    count->overflow = 0;
+    count->stopped = -1;
+    count->states = 0;
+    count->widest = 0;
+    count->fillings = 0;
+    count->seconds = 0;
+    return count;
+}
+
+void count_free(count_t *count)
+{
+    free(count);
+}
+
+static count_table_t *count_table_create(int width)
+{
+    count_table_t *table = malloc(sizeof(count_table_t));
+    table->width = width;
+    table->used = 0;
+    table->capacity = 1024;
+    table->slots = malloc(sizeof(long) * table->capacity);
+    memset(table->slots, -1, sizeof(long) * table->capacity);
+    table->keys = malloc(sizeof(mask_t) * width * table->capacity / 2);
+    table->totals = malloc(sizeof(count_total_t) * table->capacity / 2);
+    return table;
+}
+
+static void count_table_free(count_table_t *table)
+{
+    free(table->slots);
+    free(table->keys);
+    free(table->totals);
+    free(table);
+}
+
+static unsigned long long count_hash(mask_t *key, int width)
+{
+    unsigned long long hash = 0x9e3779b97f4a7c15ULL;
+    for (int k = 0; k < width; k++) {
+        hash = (hash ^ (unsigned long long)key[k]) * 0xff51afd7ed558ccdULL;
+        hash = (hash ^ (unsigned long long)(key[k] >> 64)) * 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+/* the slot of key, or the empty slot it goes to */
+static long count_table_find(count_table_t *table, mask_t *key)
+{
+    long mask = table->capacity - 1;
+    long slot = count_hash(key, table->width) & mask;
+    while (table->slots[slot] != -1
+        && memcmp(table->keys + table->width * table->slots[slot], key, sizeof(mask_t) * table->width)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void count_table_grow(count_table_t *table)
+{
+    table->capacity *= 2;
+    table->slots = realloc(table->slots, sizeof(long) * table->capacity);
+    memset(table->slots, -1, sizeof(long) * table->capacity);
+    table->keys = realloc(table->keys, sizeof(mask_t) * table->width * table->capacity / 2);
+    table->totals = realloc(table->totals, sizeof(count_total_t) * table->capacity / 2);
+    for (long index = 0; index < table->used; index++) {
+        table->slots[count_table_find(table, table->keys + table->width * index)] = index;
+    }
+}
+
+/* add total partial grids to the state of key; returns 0 if its count overflowed */
+static int count_table_add(count_table_t *table, mask_t *key, count_total_t total)
+{
+    long slot = count_table_find(table, key);
+    long index = table->slots[slot];
+
+    if (index != -1) {
+        return !__builtin_add_overflow(table->totals[index], total, table->totals + index);
+    }
+    index = table->used++;
+    memcpy(table->keys + table->width * index, key, sizeof(mask_t) * table->width);
+    table->totals[index] = total;
+    table->slots[slot] = index;
+    if (2 * table->used == table->capacity) {
+        count_table_grow(table);
+    }
+    return 1;
+}
+
+/* relabel the free numbers of state by the cols and chunks holding them; returns 1 if any moved */
+static int count_sort_numbers(count_walk_t *walk, mask_t *state)
+{
+    int scale = walk->scale, order = walk->order;
+    mask_t where[129];
+    int chunkwhere[129], nums[128], sorted[128], label[129];
+    int total = 0, moved = 0;
+
+    for (int num = 1; num <= scale; num++) {
+        if (walk->freenums & mask_of(num)) {
+            nums[total++] = num;
+            where[num] = 0;
+            chunkwhere[num] = 0;
+        }
+    }
+    for (int col = 0; col < scale; col++) {
+        mask_t rest = state[col] & walk->freenums;
+        while (rest) {
+            where[mask_first(rest)] |= (mask_t)1 << col;
+            rest &= rest - 1;
+        }
+    }
+    for (int k = 0; k < order; k++) {
+        mask_t rest = state[scale+k] & walk->freenums;
+        while (rest) {
+            chunkwhere[mask_first(rest)] |= 1 << k;
+            rest &= rest - 1;
+        }
+    }
+
+    /* the numbers held most to the left go first */
+    for (int i = 0; i < total; i++) {
+        int num = nums[i], j = i;
+        while (j > 0 && (where[sorted[j-1]] < where[num]
+            || (where[sorted[j-1]] == where[num] && chunkwhere[sorted[j-1]] < chunkwhere[num]))) {
+            sorted[j] = sorted[j-1];
+            j--;
+        }
+        sorted[j] = num;
+    }
+    for (int i = 0; i < total; i++) {
+        label[sorted[i]] = nums[i];
+        moved |= sorted[i] != nums[i];
+    }
+    if (!moved) {
+        return 0;
+    }
+
+    for (int k = 0; k < scale + order; k++) {
+        mask_t rest = state[k] & walk->freenums;
+        state[k] &= ~walk->freenums;
+        while (rest) {
+            state[k] |= mask_of(label[mask_first(rest)]);
+            rest &= rest - 1;
+        }
+    }
+    return 1;
+}
+
+/* sort the free cols of every stack by their masks; returns 1 if any moved */
+static int count_sort_cols(count_walk_t *walk, mask_t *state)
+{
+    int order = walk->order;
+    int moved = 0;
+
+    for (int stack = 0; stack < order; stack++) {
+        int cols[11], total = 0;
+        for (int col = stack * order; col < (stack + 1) * order; col++) {
+            if (walk->freecols[col]) {
+                cols[total++] = col;
+            }
+        }
+        for (int i = 1; i < total; i++) {
+            mask_t mask = state[cols[i]];
+            int j = i;
+            while (j > 0 && state[cols[j-1]] < mask) {
+                state[cols[j]] = state[cols[j-1]];
+                j--;
+            }
+            state[cols[j]] = mask;
+            moved |= j != i;
+        }
+    }
+    return moved;
+}
+
+/* compare stacks a and b of state by their chunk, then their cols */
+static int count_compare_stacks(count_walk_t *walk, mask_t *state, int a, int b)
+{
+    int scale = walk->scale, order = walk->order;
+
+    if (state[scale+a] != state[scale+b]) {
+        return state[scale+a] < state[scale+b] ? -1 : 1;
+    }
+    for (int i = 0; i < order; i++) {
+        if (state[order*a+i] != state[order*b+i]) {
+            return state[order*a+i] < state[order*b+i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/* sort the free stacks by their masks; returns 1 if any moved */
+static int count_sort_stacks(count_walk_t *walk, mask_t *state)
+{
+    int scale = walk->scale, order = walk->order;
+    int stacks[11], sorted[11], total = 0, moved = 0;
+    mask_t copy[139];
+
+    for (int stack = 0; stack < order; stack++) {
+        if (walk->freestacks[stack]) {
+            stacks[total++] = stack;
+        }
+    }
+    for (int i = 0; i < total; i++) {
+        int j = i;
+        while (j > 0 && count_compare_stacks(walk, state, sorted[j-1], stacks[i]) < 0) {
+            sorted[j] = sorted[j-1];
+            j--;
+        }
+        sorted[j] = stacks[i];
+    }
+    for (int i = 0; i < total; i++) {
+        moved |= sorted[i] != stacks[i];
+    }
+    if (!moved) {
+        return 0;
+    }
+
+    memcpy(copy, state, sizeof(mask_t) * (scale + order));
+    for (int i = 0; i < total; i++) {
+        memcpy(state + order * stacks[i], copy + order * sorted[i], sizeof(mask_t) * order);
+        state[scale+stacks[i]] = copy[scale+sorted[i]];
+    }
+    return 1;
+}
+
+static void count_canonical(count_walk_t *walk, mask_t *state)
+{
+    for (int round = 0; round < COUNT_ROUNDS; round++) {
+        int moved = count_sort_numbers(walk, state);
+        moved |= count_sort_cols(walk, state);
+        moved |= count_sort_stacks(walk, state);
+        if (!moved) {
+            break;
+        }
+    }
+}
+
+/* fill the row from col on in every way, used holding its numbers so far
+ * returns 0 if a count overflowed, or -1 if the states ran over limit
+ */
+static int count_fill(count_walk_t *walk, int col, mask_t used)
+{
+    int scale = walk->scale, order = walk->order;
+
+    if (col == scale) {
+        memcpy(walk->state, walk->cols, sizeof(mask_t) * scale);
+        for (int k = 0; k < order; k++) {
+            walk->state[scale+k] = walk->last ? 0 : walk->chunks[k];
+        }
+        count_canonical(walk, walk->state);
+        walk->count->fillings++;
+        if (!count_table_add(walk->next, walk->state, walk->weight)) {
+            return 0;
+        }
+        return walk->count->limit == 0 || walk->next->used <= walk->count->limit ? 1 : -1;
+    }
+
+    int given = walk->map[scale*walk->row+col];
+    mask_t *chunk = walk->chunks + col / order;
+    mask_t notes = given ? mask_of(given) : walk->full & ~walk->bans[col];
+    notes &= ~(walk->cols[col] | *chunk | used);
+    while (notes) {
+        mask_t bit = notes & -notes;
+        notes ^= bit;
+        walk->cols[col] |= bit;
+        *chunk |= bit;
+        int ok = count_fill(walk, col + 1, used | bit);
+        walk->cols[col] ^= bit;
+        *chunk ^= bit;
+        if (ok != 1) {
+            return ok;
+        }
+    }
+    return 1;
+}
+
+/* the bans of the voids of row, and the numbers, cols and stacks free of givens below it */
+static void count_prepare(count_walk_t *walk, int row)
+{
+    int scale = walk->scale, order = walk->order;
+    cell_t *map = walk->map;
+    mask_t inrow = 0;
+
+    walk->row = row;
+    walk->last = (row + 1) % order == 0;
+    walk->freenums = walk->full;
+    for (int col = 0; col < scale; col++) {
+        walk->bans[col] = 0;
+        walk->freecols[col] = 1;
+        if (map[scale*row+col]) {
+            inrow |= mask_of(map[scale*row+col]);
+        }
+    }
+    for (int i = row + 1; i < scale; i++) {
+        for (int col = 0; col < scale; col++) {
+            int num = map[scale*i+col];
+            if (num == 0) {
+                continue;
+            }
+            walk->freenums &= ~mask_of(num);
+            walk->freecols[col] = 0;
+            walk->bans[col] |= mask_of(num);
+            /* below in the same band, every col of the stack */
+            if (i / order == row / order) {
+                for (int other = col / order * order; other < (col / order + 1) * order; other++) {
+                    walk->bans[other] |= mask_of(num);
+                }
+            }
+        }
+    }
+    for (int col = 0; col < scale; col++) {
+        walk->bans[col] |= inrow;
+    }
+    for (int stack = 0; stack < order; stack++) {
+        walk->freestacks[stack] = 1;
+        for (int col = stack * order; col < (stack + 1) * order; col++) {
+            walk->freestacks[stack] &= walk->freecols[col];
+        }
+    }
+}
+
+int count_exact(count_t *count)
+{
+    puzzle_t *puzzle = count->puzzle;
+    int order = puzzle->order, scale = puzzle->scale;
+    int width = scale + order;
+    struct timespec start, stop;
+    int ok = 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    count_walk_t walk = {
+        .order = order,
+        .scale = scale,
+        .map = puzzle->map,
+        .full = scale == 128 ? ~(mask_t)0 : ((mask_t)1 << scale) - 1,
+        .cols = malloc(sizeof(mask_t) * scale),
+        .chunks = malloc(sizeof(mask_t) * order),
+        .bans = malloc(sizeof(mask_t) * scale),
+        .freecols = malloc(scale),
+        .freestacks = malloc(order),
+        .state = calloc(width, sizeof(mask_t)),
+        .count = count
+    };
+
+    /* the empty grid is the only state before the first row */
+    count_table_t *table = count_table_create(width);
+    count_table_add(table, walk.state, 1);
+    count->total = 0;
+    count->states = 0;
+    count->widest = 0;
+    count->fillings = 0;
+    count->overflow = 0;
+    count->stopped = -1;
+
+    for (int row = 0; row < scale && ok == 1; row++) {
+        count_prepare(&walk, row);
+        walk.next = count_table_create(width);
+        for (long index = 0; index < table->used && ok == 1; index++) {
+            mask_t *key = table->keys + width * index;
+            memcpy(walk.cols, key, sizeof(mask_t) * scale);
+            memcpy(walk.chunks, key + scale, sizeof(mask_t) * order);
+            walk.weight = table->totals[index];
+            ok = count_fill(&walk, 0, 0);
+        }
+        count_table_free(table);
+        table = walk.next;
+        count->states += table->used;
+        if (table->used > count->widest) {
+            count->widest = table->used;
+        }
+        if (ok == -1) {
+            count->stopped = row;
+        }
+    }
+    for (long index = 0; index < table->used && ok == 1; index++) {
+        ok = !__builtin_add_overflow(count->total, table->totals[index], &count->total);
+    }
+    count->overflow = ok == 0;
+    count_table_free(table);
+
+    free(walk.cols);
+    free(walk.chunks);
+    free(walk.bans);
+    free(walk.freecols);
+    free(walk.freestacks);
+    free(walk.state);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    count->seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    return ok;
+}
+
+long count_search(puzzle_t *puzzle)
+{
+    search_t *search = search_create(puzzle);
+    long total = 0;
+
+    if (search == NULL) {
+        return -1;
+    }
+    while (search_run(search) == 1) {
+        total++;
+    }
+    search_free(search);
+    return total;
+}
+
+int count_print(char *text, count_total_t total)
+{
+    char digits[COUNT_DIGITS];
+    int length = 0;
+
+    do {
+        digits[length++] = '0' + (int)(total % 10);
+        total /= 10;
+    } while (total != 0);
+    for (int i = 0; i < length; i++) {
+        text[i] = digits[length-1-i];
+    }
+    text[length] = '\0';
+    return length;
+}
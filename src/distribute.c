@@ -0,0 +1,520 @@
+// SPDX-License-Identifier: MIT License
+/* distribute.c -- multi-process search over job files
+ * the search tree is expanded to a frontier of a few guesses, and every frontier node is
+ * written to a directory as a job file holding the givens and its decisions, so a job can be
+ * run by any process on any host sharing the directory. a job writes its solutions and count
+ * to a result file, renamed into place when complete, and merging adds up the results.
+ *
+ * job file:
+ *     job 12
+ *     order 3
+ *     givens 0 0 5 3 0 ...
+ *     decisions 2 40 3 41 7
+ * result file: the solutions in a corpus format, then "count N" as the last line.
+ * claim file: "pid 4711 host node7 time 1735689600", the worker running the job.
+ *
+ * a worker killed in a job leaves its claim without a result. the claim of a process gone
+ * from the same host is stale, and so is one older than a timeout for other hosts, whose
+ * processes can't be checked. a live process of the same host keeps its claim however old.
+ * a stale claim is removed under a lock file before it is taken over, so of two workers
+ * finding it stale only one removes it, and a worker removes its own claim only if it still
+ * holds it.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <distribute.h>
+#include <enumerate.h>
+#include <search.h>
+#include <corpus.h>
+#include <puzzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define DISTRIBUTE_PATH 4096
+/* seconds after which a lock of a takeover is taken for left by a killed worker */
+#define DISTRIBUTE_LOCK 60
+
+static int distribute_compare(const void *a, const void *b)
+{
+    return strcmp(*(char **)a, *(char **)b);
+}
+
+/* the names of the jobs in dir without suffix, sorted; returns the count */
+static int distribute_list(char *dir, char ***names)
+{
+    DIR *pd = opendir(dir);
+    struct dirent *entry;
+    int count = 0, capacity = 64;
+
+    *names = malloc(sizeof(char *) * capacity);
+    if (pd == NULL) {
+        return 0;
+    }
+    while ((entry = readdir(pd)) != NULL) {
+        int length = strlen(entry->d_name);
+        if (length <= 4 || strcmp(entry->d_name + length - 4, ".job")) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            *names = realloc(*names, sizeof(char *) * capacity);
+        }
+        (*names)[count] = strndup(entry->d_name, length - 4);
+        count++;
+    }
+    closedir(pd);
+    qsort(*names, count, sizeof(char *), distribute_compare);
+
+    return count;
+}
+
+static void distribute_free_list(char **names, int count)
+{
+    for (int i = 0; i < count; i++) {
+        free(names[i]);
+    }
+    free(names);
+}
+
+/* returns 1 if the result of a job is there */
+static int distribute_done(char *dir, char *name)
+{
+    char path[DISTRIBUTE_PATH];
+    snprintf(path, sizeof(path), "%s/%s.result", dir, name);
+    return access(path, F_OK) == 0;
+}
+
+int distribute_split(puzzle_t *puzzle, char *dir, int split)
+{
+    char path[DISTRIBUTE_PATH];
+    int totaljob;
+
+    if (puzzle->scale > 128) {
+        return -1;
+    }
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    if (split < 1) {
+        split = 1;
+    }
+
+    int *jobs = enumerate_frontier(puzzle, split, &totaljob);
+    for (int j = 0; j < totaljob; j++) {
+        snprintf(path, sizeof(path), "%s/job-%06d.job", dir, j);
+        FILE *pf = fopen(path, "w");
+        if (pf == NULL) {
+            free(jobs);
+            return -1;
+        }
+        fprintf(pf, "job %d\norder %d\ngivens", j, puzzle->order);
+        for (int i = 0; i < puzzle->size; i++) {
+            fprintf(pf, " %d", puzzle->map[i]);
+        }
+        int *decision = jobs + 2 * split * j;
+        int count = 0;
+        while (count < split && decision[2*count] != -1) {
+            count++;
+        }
+        fprintf(pf, "\ndecisions %d", count);
+        for (int d = 0; d < count; d++) {
+            fprintf(pf, " %d %d", decision[2*d], decision[2*d+1]);
+        }
+        fprintf(pf, "\n");
+        fclose(pf);
+    }
+    free(jobs);
+
+    return totaljob;
+}
+
+long distribute_job(char *jobpath, char *resultpath, int emit, int format, long limit)
+{
+    char temppath[DISTRIBUTE_PATH];
+    int job, order, count;
+    long found = 0;
+
+    FILE *pf = fopen(jobpath, "r");
+    if (pf == NULL) {
+        return -1;
+    }
+    if (fscanf(pf, " job %d order %d givens", &job, &order) != 2 || order < 2 || order > 11) {
+        fclose(pf);
+        return -1;
+    }
+
+    puzzle_t puzzle = {
+        .order = order,
+        .scale = order * order,
+        .size = order * order * order * order,
+        .map = malloc(sizeof(cell_t) * order * order * order * order)
+    };
+    int ok = 1;
+    for (int i = 0; i < puzzle.size && ok; i++) {
+        int num;
+        ok = fscanf(pf, "%d", &num) == 1 && num >= 0 && num <= puzzle.scale;
+        puzzle.map[i] = num;
+    }
+    ok = ok && fscanf(pf, " decisions %d", &count) == 1;
+    search_t *search = ok ? search_create(&puzzle) : NULL;
+    for (int d = 0; d < count && search != NULL && ok; d++) {
+        int cell, num;
+        ok = fscanf(pf, "%d %d", &cell, &num) == 2 && cell >= 0 && cell < puzzle.size
+            && num >= 1 && num <= puzzle.scale && search_assume(search, cell, num);
+    }
+    fclose(pf);
+    free(puzzle.map);
+    if (search == NULL || !ok) {
+        if (search != NULL) {
+            search_free(search);
+        }
+        return -1;
+    }
+
+    /* written aside and renamed, so a result is either complete or missing */
+    snprintf(temppath, sizeof(temppath), "%s.tmp", resultpath);
+    pf = fopen(temppath, "w");
+    if (pf == NULL) {
+        search_free(search);
+        return -1;
+    }
+    char *text = malloc(corpus_length(format, search->size));
+    while ((limit == 0 || found < limit) && search_run(search)) {
+        found++;
+        if (emit == DISTRIBUTE_SOLUTIONS) {
+            int length = corpus_print(text, format, search->map, search->scale, search->size);
+            fwrite(text, 1, length, pf);
+        }
+    }
+    fprintf(pf, "count %ld\n", found);
+    free(text);
+    search_free(search);
+
+    if (fclose(pf) != 0 || rename(temppath, resultpath) != 0) {
+        return -1;
+    }
+    return found;
+}
+
+/* read the owner of a claim; returns 0 if it is gone, or holds no owner yet */
+static int distribute_owner(char *claimpath, char *owner, int size, long *pid, char *host, long *since)
+{
+    owner[0] = '\0';
+    FILE *pf = fopen(claimpath, "r");
+    if (pf == NULL) {
+        return 0;
+    }
+    int length = fread(owner, 1, size - 1, pf);
+    fclose(pf);
+    owner[length] = '\0';
+    owner[strcspn(owner, "\n")] = '\0';
+    return sscanf(owner, "pid %ld host %255s time %ld", pid, host, since) == 3;
+}
+
+/* returns 1 if the claim was left by a dead process of this host, or one of another host
+ * is older than stale seconds
+ */
+static int distribute_stale(char *claimpath, char *owner, int size, long stale)
+{
+    char host[256], here[256];
+    long pid, since;
+    struct stat status;
+
+    if (stale == -1) {
+        return distribute_owner(claimpath, owner, size, &pid, host, &since) || access(claimpath, F_OK) == 0;
+    }
+    if (!distribute_owner(claimpath, owner, size, &pid, host, &since)) {
+        /* a claim without owner is being written, or was left half written */
+        if (stat(claimpath, &status) != 0) {
+            return 0;
+        }
+        since = status.st_mtime;
+        return stale > 0 && time(NULL) - since > stale;
+    }
+    gethostname(here, sizeof(here));
+    here[sizeof(here)-1] = '\0';
+    if (!strcmp(host, here)) {
+        return kill((pid_t)pid, 0) == -1 && errno == ESRCH;
+    }
+    return stale > 0 && time(NULL) - since > stale;
+}
+
+/* remove a stale claim under its lock; returns 1 if the one judged stale was removed */
+static int distribute_takeover(char *claimpath, char *owner, long stale)
+{
+    char lockpath[DISTRIBUTE_PATH+8], again[512];
+    struct stat status;
+
+    snprintf(lockpath, sizeof(lockpath), "%s.lock", claimpath);
+    int fd = open(lockpath, O_CREAT | O_EXCL | O_WRONLY, 0644);
+    if (fd == -1) {
+        /* a lock is held for a moment, an old one was left by a worker killed holding it */
+        if (stat(lockpath, &status) == 0 && time(NULL) - status.st_mtime > DISTRIBUTE_LOCK) {
+            unlink(lockpath);
+        }
+        return 0;
+    }
+    close(fd);
+    /* only a taker holding the lock or the owner of the claim removes it, so a claim reading
+     * the same is still the one judged stale
+     */
+    int taken = distribute_stale(claimpath, again, sizeof(again), stale) && !strcmp(again, owner)
+        && unlink(claimpath) == 0;
+    unlink(lockpath);
+    return taken;
+}
+
+int distribute_work(char *dir, int emit, int format, long limit, long stale)
+{
+    char jobpath[DISTRIBUTE_PATH], resultpath[DISTRIBUTE_PATH], claimpath[DISTRIBUTE_PATH];
+    char host[256], owner[512], mine[512], held[512];
+    char **names;
+    int total = distribute_list(dir, &names);
+    int run = 0;
+
+    gethostname(host, sizeof(host));
+    host[sizeof(host)-1] = '\0';
+
+    for (int i = 0; i < total; i++) {
+        if (distribute_done(dir, names[i])) {
+            continue;
+        }
+        /* the claim is created exclusively, so only one worker gets a job */
+        snprintf(claimpath, sizeof(claimpath), "%s/%s.claim", dir, names[i]);
+        int fd = open(claimpath, O_CREAT | O_EXCL | O_WRONLY, 0644);
+        if (fd == -1 && errno == EEXIST && distribute_stale(claimpath, owner, sizeof(owner), stale)
+            && distribute_takeover(claimpath, owner, stale)) {
+            printf("[okey] job %s: stale claim taken over, %s\n", names[i], owner[0] ? owner : "no owner");
+            fd = open(claimpath, O_CREAT | O_EXCL | O_WRONLY, 0644);
+        }
+        if (fd == -1) {
+            continue;
+        }
+        snprintf(mine, sizeof(mine), "pid %ld host %s time %ld", (long)getpid(), host, (long)time(NULL));
+        dprintf(fd, "%s\n", mine);
+        close(fd);
+        /* finished by another worker between listing and claiming */
+        if (!distribute_done(dir, names[i])) {
+            snprintf(jobpath, sizeof(jobpath), "%s/%s.job", dir, names[i]);
+            snprintf(resultpath, sizeof(resultpath), "%s/%s.result", dir, names[i]);
+            long found = distribute_job(jobpath, resultpath, emit, format, limit);
+            if (found < 0) {
+                printf("[error] job %s is broken\n", names[i]);
+            }
+            else {
+                printf("[okey] job %s: %ld solutions\n", names[i], found);
+                run++;
+            }
+            fflush(stdout);
+        }
+        /* taken over meanwhile, the claim is the other worker's now */
+        long pid, since;
+        char owned[256];
+        distribute_owner(claimpath, held, sizeof(held), &pid, owned, &since);
+        if (!strcmp(held, mine)) {
+            unlink(claimpath);
+        }
+    }
+    distribute_free_list(names, total);
+
+    return run;
+}
+
+/* a forked worker: run the jobs named on in and report their counts on out */
+static void distribute_worker(char *dir, int in, int out, int emit, int format, long limit)
+{
+    char jobpath[DISTRIBUTE_PATH], resultpath[DISTRIBUTE_PATH], name[256];
+    FILE *pin = fdopen(in, "r");
+    FILE *pout = fdopen(out, "w");
+
+    while (fgets(name, sizeof(name), pin) != NULL) {
+        name[strcspn(name, "\n")] = '\0';
+        snprintf(jobpath, sizeof(jobpath), "%s/%s.job", dir, name);
+        snprintf(resultpath, sizeof(resultpath), "%s/%s.result", dir, name);
+        fprintf(pout, "%s %ld\n", name, distribute_job(jobpath, resultpath, emit, format, limit));
+        fflush(pout);
+    }
+    _exit(0);
+}
+
+long distribute_local(char *dir, int workers, int emit, int format, long limit)
+{
+    char **names;
+    int total = distribute_list(dir, &names);
+    int next = 0;
+    long found = 0;
+    char line[512];
+
+    if (workers < 1) {
+        workers = 1;
+    }
+    pid_t *pids = malloc(sizeof(pid_t) * workers);
+    int *tojob = malloc(sizeof(int) * workers);
+    FILE **fromjob = malloc(sizeof(FILE *) * workers);
+    struct pollfd *polls = malloc(sizeof(struct pollfd) * workers);
+
+    /* inherited buffers would be printed twice */
+    fflush(stdout);
+    /* a worker gone early shouldn't kill the coordinator */
+    void (*pipehandler)(int) = signal(SIGPIPE, SIG_IGN);
+    for (int w = 0; w < workers; w++) {
+        int down[2], up[2];
+        if (pipe(down) != 0 || pipe(up) != 0) {
+            workers = w;
+            break;
+        }
+        pids[w] = fork();
+        if (pids[w] < 0) {
+            close(down[0]);
+            close(down[1]);
+            close(up[0]);
+            close(up[1]);
+            workers = w;
+            break;
+        }
+        if (pids[w] == 0) {
+            /* the pipes of the other workers would keep them from seeing the end */
+            for (int v = 0; v < w; v++) {
+                close(tojob[v]);
+                fclose(fromjob[v]);
+            }
+            close(down[1]);
+            close(up[0]);
+            distribute_worker(dir, down[0], up[1], emit, format, limit);
+        }
+        close(down[0]);
+        close(up[1]);
+        tojob[w] = down[1];
+        fromjob[w] = fdopen(up[0], "r");
+        polls[w].fd = up[0];
+        polls[w].events = POLLIN;
+    }
+
+    /* every worker gets one job at a time */
+    for (int w = 0; w < workers; w++) {
+        while (next < total && distribute_done(dir, names[next])) {
+            next++;
+        }
+        if (next < total) {
+            dprintf(tojob[w], "%s\n", names[next++]);
+        }
+        else {
+            close(tojob[w]);
+            tojob[w] = -1;
+        }
+    }
+
+    int running = workers;
+    while (running > 0) {
+        if (poll(polls, workers, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int w = 0; w < workers; w++) {
+            if (polls[w].fd == -1 || !(polls[w].revents & (POLLIN | POLLHUP))) {
+                continue;
+            }
+            long count;
+            if (fgets(line, sizeof(line), fromjob[w]) == NULL) {
+                /* the worker is gone */
+                fclose(fromjob[w]);
+                polls[w].fd = -1;
+                running--;
+                continue;
+            }
+            if (sscanf(line, "%*s %ld", &count) == 1 && count >= 0) {
+                found += count;
+            }
+            else {
+                printf("[error] job %s", line);
+            }
+
+            while (next < total && distribute_done(dir, names[next])) {
+                next++;
+            }
+            if (limit != 0 && found >= limit) {
+                /* enough, the other jobs can be left */
+                for (int v = 0; v < workers; v++) {
+                    if (tojob[v] != -1) {
+                        close(tojob[v]);
+                        tojob[v] = -1;
+                    }
+                    if (polls[v].fd != -1) {
+                        kill(pids[v], SIGTERM);
+                    }
+                }
+            }
+            else if (next < total) {
+                dprintf(tojob[w], "%s\n", names[next++]);
+            }
+            else if (tojob[w] != -1) {
+                close(tojob[w]);
+                tojob[w] = -1;
+            }
+        }
+    }
+    for (int w = 0; w < workers; w++) {
+        waitpid(pids[w], NULL, 0);
+    }
+    signal(SIGPIPE, pipehandler);
+
+    free(pids);
+    free(tojob);
+    free(fromjob);
+    free(polls);
+    distribute_free_list(names, total);
+
+    return limit != 0 && found > limit ? limit : found;
+}
+
+long distribute_merge(char *dir, FILE *pf, int *missing)
+{
+    char path[DISTRIBUTE_PATH];
+    char **names;
+    int total = distribute_list(dir, &names);
+    char *line = NULL;
+    size_t capacity = 0;
+    long found = 0;
+
+    *missing = 0;
+    for (int i = 0; i < total; i++) {
+        snprintf(path, sizeof(path), "%s/%s.result", dir, names[i]);
+        FILE *pr = fopen(path, "r");
+        long count = -1;
+        if (pr != NULL) {
+            while (getline(&line, &capacity, pr) != -1) {
+                if (!strncmp(line, "count ", 6)) {
+                    count = atol(line + 6);
+                }
+                else if (pf != NULL) {
+                    fputs(line, pf);
+                }
+            }
+            fclose(pr);
+        }
+        if (count < 0) {
+            (*missing)++;
+        }
+        else {
+            found += count;
+        }
+    }
+    free(line);
+    distribute_free_list(names, total);
+
+    return found;
+}
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MIT License
+/* enumerate.c -- streaming enumeration of solutions
+ * solutions are printed as soon as they are found, so memory doesn't grow with the count.
+ * to run in parallel, the search tree is expanded to a frontier of a few guesses first,
+ * every frontier node is a job of decisions, and the threads take jobs one by one.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <enumerate.h>
+#include <search.h>
+#include <corpus.h>
+#include <puzzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define ENUMERATE_BUFFER 65536
+
+typedef struct enumerate {
+    puzzle_t *puzzle; /* puzzle to enumerate */
+    FILE *pf; /* output sink */
+    int format; /* corpus format */
+    long limit; /* most solutions to write, 0 for all */
+    int split; /* guesses of every job */
+    int totaljob; /* the total amount of jobs */
+    int *jobs; /* decisions of every job, cell and number in pairs, -1 for unused */
+    int nextjob; /* the next job to take */
+    long found; /* solutions written */
+    int stop; /* the limit is reached */
+}enumerate_t;
+
+/* take jobs and write their solutions until no job is left */
+static void *enumerate_worker(void *data)
+{
+    enumerate_t *en = data;
+    search_t *search = search_create(en->puzzle);
+    int length = corpus_length(en->format, search->size);
+    char *buffer = malloc(ENUMERATE_BUFFER + length);
+    int used = 0;
+    int job, ok;
+    long index;
+
+    while (!__atomic_load_n(&en->stop, __ATOMIC_RELAXED)) {
+        job = __atomic_fetch_add(&en->nextjob, 1, __ATOMIC_RELAXED);
+        if (job >= en->totaljob) {
+            break;
+        }
+
+        /* replay the decisions of the job */
+        search_reset(search);
+        ok = 1;
+        int *decision = en->jobs + 2 * en->split * job;
+        for (int d = 0; d < en->split && decision[2*d] != -1 && ok; d++) {
+            ok = search_assume(search, decision[2*d], decision[2*d+1]);
+        }
+
+        while (ok && search_run(search)) {
+            index = __atomic_add_fetch(&en->found, 1, __ATOMIC_RELAXED);
+            if (en->limit != 0 && index > en->limit) {
+                __atomic_store_n(&en->stop, 1, __ATOMIC_RELAXED);
+                break;
+            }
+            used += corpus_print(buffer + used, en->format, search->map, search->scale, search->size);
+            if (used >= ENUMERATE_BUFFER) {
+                fwrite(buffer, 1, used, en->pf);
+                used = 0;
+            }
+            if (index == en->limit) {
+                __atomic_store_n(&en->stop, 1, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+    }
+    fwrite(buffer, 1, used, en->pf);
+
+    free(buffer);
+    search_free(search);
+    return NULL;
+}
+
+int *enumerate_frontier(puzzle_t *puzzle, int split, int *totaljob)
+{
+    search_t *search = search_create(puzzle);
+    int capacity = 64;
+    int *jobs, *decision;
+
+    jobs = malloc(sizeof(int) * 2 * split * capacity);
+    *totaljob = 0;
+    while (search_dive(search, split)) {
+        if (*totaljob == capacity) {
+            capacity *= 2;
+            jobs = realloc(jobs, sizeof(int) * 2 * split * capacity);
+        }
+        decision = jobs + 2 * split * (*totaljob)++;
+        for (int d = 0; d < split; d++) {
+            if (d < search->guessed) {
+                search_guess_t *guess = search->guesses + d;
+                decision[2*d] = guess->cell;
+                decision[2*d+1] = guess->nums[guess->choice];
+            }
+            else {
+                decision[2*d] = -1;
+                decision[2*d+1] = -1;
+            }
+        }
+    }
+    search_free(search);
+
+    return jobs;
+}
+
+long enumerate_main(puzzle_t *puzzle, FILE *pf, int format, long limit, int threads, int split)
+{
+    if (puzzle->scale > 128) {
+        return -1;
+    }
+
+    enumerate_t en = {
+        .puzzle = puzzle,
+        .pf = pf,
+        .format = format,
+        .limit = limit,
+        .split = split,
+        .nextjob = 0,
+        .found = 0,
+        .stop = 0
+    };
+
+    if (threads <= 1 || split <= 0) {
+        /* one job without decisions */
+        en.split = 1;
+        en.totaljob = 1;
+        en.jobs = malloc(sizeof(int) * 2);
+        en.jobs[0] = -1;
+        en.jobs[1] = -1;
+        enumerate_worker(&en);
+    }
+    else {
+        en.jobs = enumerate_frontier(puzzle, split, &en.totaljob);
+        pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+        for (int t = 0; t < threads; t++) {
+            pthread_create(workers + t, NULL, enumerate_worker, &en);
+        }
+        for (int t = 0; t < threads; t++) {
+            pthread_join(workers[t], NULL);
+        }
+        free(workers);
+    }
+    fflush(pf);
+    free(en.jobs);
+
+    return en.limit != 0 && en.found > en.limit ? en.limit : en.found;
+}
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: MIT License
+/* estimate.c -- the search tree size estimator
+ * a probe walks from the root to a leaf the way the search does, propagating and guessing
+ * the void its branching picks, but takes one number of the guess at random and never
+ * draws back. if the guesses on its way had d1, d2, ..., dk numbers, the tree holds about
+ * d1 + d1*d2 + ... + d1*d2*...*dk guesses, and the mean over probes is unbiased (Knuth).
+ *
+ * the tree estimated is the whole one without backjumping and nogoods, so it bounds from
+ * above the guesses to prove no solution, and a search stopping at the first solution
+ * takes a part of it, often a tiny one on puzzles of many solutions. so with first set,
+ * probing stops at the first probe reaching a solution, which counts the guesses of its
+ * way only, as the search would walk down one like it: a puzzle of many solutions is then
+ * estimated by a few guesses, and one no probe solves by its whole tree. the spread of
+ * probes is wide on hard puzzles, so the confidence interval is only as good as the count
+ * of probes.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <estimate.h>
+#include <search.h>
+#include <puzzle.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+estimate_t *estimate_create(puzzle_t *puzzle)
+{
+    search_t *search = search_create(puzzle);
+    if (search == NULL) {
+        return NULL;
+    }
+
+    estimate_t *estimate = malloc(sizeof(estimate_t));
+    estimate->search = search;
+    estimate->seed = 0;
+    estimate->limit = ESTIMATE_PROBES;
+    estimate->first = 0;
+    estimate->budget = ESTIMATE_SECONDS;
+    estimate->probes = 0;
+    estimate->solutions = 0;
+    estimate->deepest = 0;
+    estimate->nodes = 0;
+    estimate->low = 0;
+    estimate->high = 0;
+    estimate->pernode = 0;
+    estimate->seconds = 0;
+    estimate->spent = 0;
+    return estimate;
+}
+
+void estimate_free(estimate_t *estimate)
+{
+    search_free(estimate->search);
+    free(estimate);
+}
+
+/* one probe from the root; returns the guesses estimated, with the propagations and the end of it */
+static double estimate_probe(search_t *search, long *steps, int *depth, int *solved)
+{
+    double product = 1, total = 0;
+
+    search_reset(search);
+    *depth = 0;
+    *solved = 0;
+    while (1) {
+        (*steps)++;
+        if (!search_propagate(search)) {
+            break;
+        }
+        if (search->totalfill == search->totalvoid) {
+            *solved = 1;
+            break;
+        }
+        /* numbers in random order, so the first one is a uniform choice */
+        search_guess(search);
+        product *= search->guesses[search->guessed-1].count;
+        total += product;
+        (*depth)++;
+    }
+    return total;
+}
+
+int estimate_run(estimate_t *estimate)
+{
+    search_t *search = estimate->search;
+    double *values = malloc(sizeof(double) * estimate->limit);
+    double sum = 0, top = 0;
+    long steps = 0;
+    struct timespec start, now;
+
+    /* the branching and propagation of the search, but a random choice at every guess
+     * a probe never draws back nor restarts, so its blame and restarts don't matter
+     */
+    search->value = SEARCH_RANDOM;
+    search_seed(search, estimate->seed);
+    estimate->probes = 0;
+    estimate->solutions = 0;
+    estimate->deepest = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        int depth, solved;
+        double nodes = estimate_probe(search, &steps, &depth, &solved);
+        if (estimate->first && solved) {
+            nodes = depth;
+        }
+        values[estimate->probes++] = nodes;
+        sum += nodes;
+        top = fmax(top, nodes);
+        estimate->solutions += solved;
+        if (depth > estimate->deepest) {
+            estimate->deepest = depth;
+        }
+        /* decided by propagation alone, every probe would be the same */
+        if (depth == 0 || (estimate->first && solved)) {
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        estimate->spent = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+    } while (estimate->probes < estimate->limit && estimate->spent < estimate->budget);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    estimate->spent = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+    search_reset(search);
+
+    /* deep trees run past 1e300, so the spread is taken in units of the largest probe */
+    int count = estimate->probes;
+    double mean = sum / count, square = 0;
+    for (int k = 0; k < count && top > 0; k++) {
+        double diff = values[k] / top - mean / top;
+        square += diff * diff;
+    }
+    double spread = count > 1 ? sqrt(square / (count - 1)) * top : 0;
+    free(values);
+    estimate->nodes = mean;
+    estimate->low = fmax(mean - 1.96 * spread / sqrt(count), 0);
+    estimate->high = mean + 1.96 * spread / sqrt(count);
+    /* one propagation at the root and one after every guess */
+    estimate->pernode = estimate->spent / steps;
+    estimate->seconds = (mean + 1) * estimate->pernode;
+    return count;
+}
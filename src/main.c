@@ -6,15 +6,97 @@
 
 #include <puzzle.h>
 #include <solver.h>
+#include <render.h>
+#include <session.h>
+#include <enumerate.h>
+#include <corpus.h>
+#include <search.h>
+#include <cnf.h>
+#include <sat.h>
+#include <checkpoint.h>
+#include <distribute.h>
+#include <task.h>
+#include <batch.h>
+#include <portfolio.h>
+#include <generate.h>
+#include <adversary.h>
+#include <validate.h>
+#include <archive.h>
+#include <overlay.h>
+#include <anneal.h>
+#include <estimate.h>
+#include <profile.h>
+#include <count.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <signal.h>
 
 void print_help();
+void run_session(puzzle_t *puzzle);
+int run_enumerate(int argc, char **argv);
+int run_solve(int argc, char **argv);
+int solve_engine(int argc, char **argv);
+int run_distribute(int argc, char **argv);
+int run_schedule(int argc, char **argv);
+int run_batch(int argc, char **argv);
+int run_generate(int argc, char **argv);
+int run_adversary(int argc, char **argv);
+int run_bench(int argc, char **argv);
+int run_estimate(int argc, char **argv);
+int run_count(int argc, char **argv);
+int run_validate(int argc, char **argv);
+int run_archive(int argc, char **argv);
+int validate_archive(archive_t *archive, int complete);
+void report_invalid(int *results, int count, long index);
+char *option_value(int argc, char **argv, char *name, char *fallback);
+int option_flag(int argc, char **argv, char *name);
+int option_search(int argc, char **argv, search_t *search);
+int run_checkpoint(search_t *search, checkpoint_t *checkpoint, double every);
 
 int main(int argc, char **argv)
 {
+    /* operates taking options */
+    if (argc >= 4 && !strcmp(argv[1], "enumerate")) {
+        return run_enumerate(argc, argv);
+    }
+    if (argc >= 4 && !strcmp(argv[1], "solve") && (argc >= 5 || argv[3][0] == '-')) {
+        return run_solve(argc, argv);
+    }
+    if ((argc >= 4 && (!strcmp(argv[1], "split") || !strcmp(argv[1], "distribute")))
+        || (argc >= 3 && (!strcmp(argv[1], "work") || !strcmp(argv[1], "merge")))) {
+        return run_distribute(argc, argv);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "schedule")) {
+        return run_schedule(argc, argv);
+    }
+    if (argc >= 4 && !strcmp(argv[1], "batch")) {
+        return run_batch(argc, argv);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "generate")) {
+        return run_generate(argc, argv);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "adversary")) {
+        return run_adversary(argc, argv);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "bench")) {
+        return run_bench(argc, argv);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "estimate")) {
+        return run_estimate(argc, argv);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "count")) {
+        return run_count(argc, argv);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "validate")) {
+        return run_validate(argc, argv);
+    }
+    if (argc >= 4 && (!strcmp(argv[1], "pack") || !strcmp(argv[1], "unpack"))) {
+        return run_archive(argc, argv);
+    }
+
     if (argc == 2) {
         if (!strcmp(argv[1], "help")) {
             print_help();
@@ -27,7 +109,13 @@ int main(int argc, char **argv)
         if (!strcmp(argv[1], "solve")) {
             puzzle_t *puzzle = puzzle_read_data(argv[2]);
             if (puzzle != NULL) {
-                solver_main(puzzle);
+                solver_main(puzzle, NULL);
+            }
+        }
+        else if (!strcmp(argv[1], "session")) {
+            puzzle_t *puzzle = puzzle_read_data(argv[2]);
+            if (puzzle != NULL) {
+                run_session(puzzle);
             }
         }
         else {
@@ -47,6 +135,20 @@ int main(int argc, char **argv)
                 }
             }
         }
+        else if (!strcmp(argv[1], "dimacs")) {
+            puzzle_t *puzzle = puzzle_read_data(argv[2]);
+            if (puzzle != NULL) {
+                cnf_t *cnf = cnf_encode(puzzle);
+                if (cnf_write_dimacs(argv[3], cnf)) {
+                    printf("[okey] %d variables and %d clauses written to %s\n",
+                        cnf->totalvar, cnf->totalclause, argv[3]);
+                }
+                else {
+                    printf("[error] failed to write %s\n", argv[3]);
+                }
+                cnf_free(cnf);
+            }
+        }
         else {
             return 1;
         }
@@ -65,12 +167,1582 @@ void print_help()
     printf("operate: \n");
     printf("    make\tmake a new puzzle and write to file.\n");
     printf("    solve\tread a puzzle and solve it.\n");
+    printf("    session\tread a puzzle and edit it from stdin, solving after every edit.\n");
+    printf("    enumerate\tread a puzzle and stream its solutions to file.\n");
+    printf("    dimacs\tread a puzzle and write its cnf encoding to file.\n");
+    printf("    split\tread a puzzle and write its search subtrees as job files to a directory.\n");
+    printf("    work\trun the job files of a directory shared with other workers.\n");
+    printf("    merge\tadd up the results of a directory and copy their solutions to file.\n");
+    printf("    distribute\tsplit a puzzle and run its jobs by local worker processes.\n");
+    printf("    schedule\tread a corpus of puzzles and solve them in turn by slices on one thread.\n");
+    printf("    batch\tread a corpus of puzzles and write their solutions to file.\n");
+    printf("    generate\tstream random complete grids to file.\n");
+    printf("    adversary\tclimb for puzzles hard to the search and append them to a corpus.\n");
+    printf("    validate\tcheck the grids of a corpus or an archive and report every invalid one.\n");
+    printf("    pack\tcode the solved grids of a corpus into a compact archive.\n");
+    printf("    unpack\tdecode an archive, or one block of it, back into a corpus.\n");
+    printf("    estimate\tread a puzzle and estimate the guesses and time of the search by random probes.\n");
+    printf("    count\tread a puzzle and count its completions by the search, or exactly.\n");
+    printf("    bench\tsolve a corpus of puzzles one by one and report the spread of guesses and time.\n");
     printf("    help\tshow this page.\n\n");
     printf("parameter: \n");
     printf("    order N\tcan be 2, 3, 4, ..., 9\n");
     printf("    default\tthe hardest sudoku in the world\n\n");
+    printf("options of solve: \n");
+    printf("    --engine E\tstep (default), search, portfolio, overlay of number templates for 9x9, anneal\n");
+    printf("    \t\tfor large sparse puzzles, or sat\n");
+    printf("    --render M\tfull (default) grid or diff of changed cells for every frame of step\n");
+    printf("    --interval MS\tleast milliseconds between frames of step, 0 (default) for every frame\n");
+    printf("    --backjump B\t1 (default) to jump back to the guess to blame, 0 to the last guess\n");
+    printf("    --branch P\tfewest (default), first or weighted void to guess\n");
+    printf("    --value V\tnatural (default), lcv or random order of numbers to guess\n");
+    printf("    --propagate S\thidden (default) and naked singles, naked singles only, or matching for\n");
+    printf("    \t\tsingles and all-different units, worth its cost from order 5\n");
+    printf("    --seed S\tseed of random order\n");
+    printf("    --restart R\tnever (default), luby or geometric restarts\n");
+    printf("    --restart-base N\tguesses of the first run before restart\n");
+    printf("    --portfolio N\trace N searches of different heuristics on threads, 4 by default\n");
+    printf("    --checkpoint F\twrite the search state of --engine search to F in the background\n");
+    printf("    --every S\tseconds between checkpoints, 60 by default\n");
+    printf("    --resume F\tgo on from checkpoint F, and keep checkpointing to it\n");
+    printf("    --threads T\tanneal T chains seeded from --seed on, 1 by default\n");
+    printf("    --time S\tseconds before annealing gives up, 60 by default\n");
+    printf("    --handoff K\thand a chain K numbers short at most to the search, 0 (default) never\n");
+    printf("    --budget N\tguesses of the search at every handoff, 10000 by default\n");
+    printf("    --profile F\tsample the stage and guess depth of the solvers, and write the report to F\n");
+    printf("    --profile-format R\tfolded (default) stacks for flame graphs, or series of stages over time\n");
+    printf("    --profile-hz N\tsamples a cpu second, 1000 by default\n\n");
+    printf("options of enumerate: \n");
+    printf("    --limit N\twrite the first N solutions only, 0 for all\n");
+    printf("    --format F\tline or compact\n");
+    printf("    --threads T\tenumerate with T threads\n");
+    printf("    --split K\tsplit the search on the first K guesses for threads\n\n");
+    printf("options of split, work and distribute: \n");
+    printf("    --split K\tone job for every node of the first K guesses, 2 by default\n");
+    printf("    --emit E\tcount (default) or solutions written to results\n");
+    printf("    --format F\tline or compact solutions\n");
+    printf("    --limit N\tstop after N solutions, 0 for all\n");
+    printf("    --workers W\tlocal worker processes of distribute\n");
+    printf("    --stale S\ttake over claims of work older than S seconds, 0 (default) for claims\n");
+    printf("    \t\tof dead processes on this host only\n");
+    printf("    --reclaim\ttake over every claim of work without result, once no worker is running\n\n");
+    printf("options of schedule: \n");
+    printf("    --format F\tline (default) or compact corpus\n");
+    printf("    --slice N\tguesses of every puzzle in its turn, 0 to solve one by one\n");
+    printf("    --inflight K\tpuzzles in flight at once\n");
+    printf("    the heuristics of solve --engine search apply to every puzzle\n\n");
+    printf("options of batch: \n");
+    printf("    --engine E\tsimd (default) to propagate 9x9 puzzles in lockstep, or search\n");
+    printf("    --format F\tline (default) or compact corpus, for both files\n");
+    printf("    --route N\testimate every puzzle first and write the ones over N guesses to --hard unsolved\n");
+    printf("    --hard F\tcorpus of the puzzles routed away, the solutions keep the order of the others\n");
+    printf("    --probes P\tprobes of every estimate, %d by default\n", ESTIMATE_PROBES);
+    printf("    the heuristics of solve --engine search set the search of --engine search and the estimates,\n");
+    printf("    which count the guesses to the first solution\n");
+    printf("    a line which is not a puzzle is echoed in place, so without --route line n of both files matches\n\n");
+    printf("options of estimate: \n");
+    printf("    --probes P\trandom probes from the root to a leaf, %d by default\n", ESTIMATE_PROBES);
+    printf("    --time S\tseconds of probing at most, %.0f by default\n", ESTIMATE_SECONDS);
+    printf("    --seed S\tseed of the probes\n");
+    printf("    --first\testimate the guesses to the first solution, stopping at the first probe reaching one\n");
+    printf("    the branching and propagation of solve --engine search are the ones estimated\n\n");
+    printf("options of count: \n");
+    printf("    --exact\tcount row by row, merging partial grids equal up to the symmetries of the givens\n");
+    printf("    --states N\tmost states after a row of --exact, %d by default, 0 for no limit\n", COUNT_STATES);
+    printf("    --check\tcount by the search too and compare, with --exact\n\n");
+    printf("options of generate: \n");
+    printf("    --order N\torder of grids from 2 to 11, 3 by default\n");
+    printf("    --count N\tgrids to write, 1000 by default\n");
+    printf("    --seed S\tseed of the grids, the time by default\n");
+    printf("    --threads T\tgenerate with T threads, the same grids in another order\n");
+    printf("    --format F\tline (default) or compact corpus, or archive\n\n");
+    printf("options of validate: \n");
+    printf("    --complete C\t1 (default) for complete grids only, 0 to allow voids\n");
+    printf("    --format F\tline (default) or compact corpus\n\n");
+    printf("options of pack and unpack: \n");
+    printf("    --format F\tline (default) or compact corpus\n");
+    printf("    --block B\tunpack block B of %d grids only, all by default\n\n", ARCHIVE_BLOCK);
+    printf("options of adversary and bench: \n");
+    printf("    --order N\torder of puzzles to climb, 3 by default\n");
+    printf("    --climbs N\tclimbs from as many random grids, 10 by default\n");
+    printf("    --steps N\tclue swaps tried by every climb, 1000 by default\n");
+    printf("    --start S\tseed of the first climb, the next climbs count on from it\n");
+    printf("    --fitness F\tnodes (default) or time to the first solution\n");
+    printf("    --unique U\t1 (default) to keep to puzzles of one solution\n");
+    printf("    --limit N\tguesses a puzzle is measured by at most, 1000000 by default, 0 for no limit\n");
+    printf("    --keep X\tappend the puzzles of fitness X or more only\n");
+    printf("    --format F\tline (default) or compact corpus\n");
+    printf("    --engine E\tsearch (default) or overlay to bench, 9x9 puzzles only for overlay\n");
+    printf("    the heuristics of solve --engine search are the ones attacked and benched\n\n");
     printf("example: \n");
     printf("    ./sudoku_solver make puzzle.dat 3\n");
     printf("    ./sudoku_solver make puzzle.dat default\n");
     printf("    ./sudoku_solver solve puzzle.dat\n");
-}
\ No newline at end of file
+    printf("    ./sudoku_solver solve puzzle.dat --engine sat\n");
+    printf("    ./sudoku_solver solve sparse.dat --engine anneal --threads 4 --handoff 8\n");
+    printf("    ./sudoku_solver solve puzzle.dat --portfolio 8\n");
+    printf("    ./sudoku_solver solve puzzle.dat --engine search --profile search.folded\n");
+    printf("    ./sudoku_solver dimacs puzzle.dat puzzle.cnf\n");
+    printf("    ./sudoku_solver session puzzle.dat\n");
+    printf("    ./sudoku_solver enumerate puzzle.dat solutions.txt --limit 1000 --threads 4\n");
+    printf("    ./sudoku_solver distribute puzzle.dat jobs --workers 8 --split 3\n");
+    printf("    ./sudoku_solver merge jobs solutions.txt\n");
+    printf("    ./sudoku_solver schedule puzzles.txt --slice 100 --inflight 1000\n");
+    printf("    ./sudoku_solver batch puzzles.txt solutions.txt --engine simd\n");
+    printf("    ./sudoku_solver batch puzzles.txt solutions.txt --route 10000 --hard hard.txt\n");
+    printf("    ./sudoku_solver estimate puzzle.dat --probes 1000 --time 5\n");
+    printf("    ./sudoku_solver count band.dat --exact\n");
+    printf("    ./sudoku_solver generate grids.txt --order 4 --count 100000 --threads 8\n");
+    printf("    ./sudoku_solver adversary killers.txt --climbs 100 --steps 2000\n");
+    printf("    ./sudoku_solver bench killers.txt --branch weighted\n");
+    printf("    ./sudoku_solver bench killers.txt --engine overlay\n");
+    printf("    ./sudoku_solver validate solutions.txt --format compact\n");
+    printf("    ./sudoku_solver pack grids.txt grids.ska --format compact\n");
+    printf("    ./sudoku_solver unpack grids.ska grids.txt --block 12\n\n");
+    printf("session commands: \n");
+    printf("    set ROW COL NUM\tput a given on a cell\n");
+    printf("    clear ROW COL\tmake a cell void\n");
+    printf("    print\t\tprint the last solution\n");
+    printf("    quit\t\tleave the session\n");
+}
+
+/* edit the puzzle from stdin, and tell whether it is still solvable after every edit */
+void run_session(puzzle_t *puzzle)
+{
+    session_t *session = session_create(puzzle);
+    if (session == NULL) {
+        printf("[error] scale %d is too large for session\n", puzzle->scale);
+        return;
+    }
+
+    char line[256], command[16];
+    int row, col, num, ok;
+    struct timespec start, stop;
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        if (sscanf(line, "%15s", command) != 1) {
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (!strcmp(command, "set") && sscanf(line, "%*s %d %d %d", &row, &col, &num) == 3) {
+            ok = session_set(session, row, col, num);
+        }
+        else if (!strcmp(command, "clear") && sscanf(line, "%*s %d %d", &row, &col) == 2) {
+            ok = session_clear(session, row, col);
+        }
+        else if (!strcmp(command, "print")) {
+            if (session_solve(session)) {
+                puzzle_t solution = *puzzle;
+                solution.map = session->solution;
+                puzzle_print_console(&solution);
+            }
+            else {
+                printf("[error] no solution\n");
+            }
+            continue;
+        }
+        else if (!strcmp(command, "quit")) {
+            break;
+        }
+        else {
+            printf("[error] unknown command %s", line);
+            continue;
+        }
+        if (!ok) {
+            printf("[error] out of range\n");
+            continue;
+        }
+        int kept = session->solved == 1;
+        int solvable = session_solve(session);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        long usec = (stop.tv_sec - start.tv_sec) * 1000000 + (stop.tv_nsec - start.tv_nsec) / 1000;
+        if (!solvable) {
+            printf("[error] no solution (%ld us)\n", usec);
+        }
+        else if (kept) {
+            printf("[okey] last solution kept (%ld us)\n", usec);
+        }
+        else {
+            printf("[okey] solved again with %ld guesses (%ld us)\n", session->nodes, usec);
+        }
+    }
+
+    session_free(session);
+}
+/* returns the argument after option name, or fallback if not given */
+char *option_value(int argc, char **argv, char *name, char *fallback)
+{
+    for (int i = 1; i < argc - 1; i++) {
+        if (!strcmp(argv[i], name)) {
+            return argv[i+1];
+        }
+    }
+    return fallback;
+}
+
+/* whether the option name without value is given */
+int option_flag(int argc, char **argv, char *name)
+{
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], name)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* set the search heuristics from options; returns 0 if any is unknown */
+int option_search(int argc, char **argv, search_t *search)
+{
+    char *branch = option_value(argc, argv, "--branch", "fewest");
+    char *value = option_value(argc, argv, "--value", "natural");
+    char *restart = option_value(argc, argv, "--restart", "never");
+    char *propagate = option_value(argc, argv, "--propagate", "hidden");
+
+    search->backjump = atoi(option_value(argc, argv, "--backjump", "1"));
+    search_seed(search, strtoull(option_value(argc, argv, "--seed", "0"), NULL, 10));
+    search->restartbase = atol(option_value(argc, argv, "--restart-base", "100"));
+
+    if (!strcmp(branch, "first")) {
+        search->branch = SEARCH_FIRST;
+    }
+    else if (!strcmp(branch, "fewest")) {
+        search->branch = SEARCH_FEWEST;
+    }
+    else if (!strcmp(branch, "weighted")) {
+        search->branch = SEARCH_WEIGHTED;
+    }
+    else {
+        printf("[error] unknown branching policy %s\n", branch);
+        return 0;
+    }
+
+    if (!strcmp(value, "natural")) {
+        search->value = SEARCH_NATURAL;
+    }
+    else if (!strcmp(value, "lcv")) {
+        search->value = SEARCH_LCV;
+    }
+    else if (!strcmp(value, "random")) {
+        search->value = SEARCH_RANDOM;
+    }
+    else {
+        printf("[error] unknown value order %s\n", value);
+        return 0;
+    }
+
+    if (!strcmp(propagate, "naked")) {
+        search->propagation = SEARCH_NAKED;
+    }
+    else if (!strcmp(propagate, "hidden")) {
+        search->propagation = SEARCH_HIDDEN;
+    }
+    else if (!strcmp(propagate, "matching")) {
+        search->propagation = SEARCH_MATCHING;
+    }
+    else {
+        printf("[error] unknown propagation strength %s\n", propagate);
+        return 0;
+    }
+
+    if (!strcmp(restart, "never")) {
+        search->restart = SEARCH_NEVER;
+    }
+    else if (!strcmp(restart, "luby")) {
+        search->restart = SEARCH_LUBY;
+    }
+    else if (!strcmp(restart, "geometric")) {
+        search->restart = SEARCH_GEOMETRIC;
+    }
+    else {
+        printf("[error] unknown restart policy %s\n", restart);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* set by SIGINT and SIGTERM while checkpointing */
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_interrupt(int sig)
+{
+    (void)sig;
+    interrupted = 1;
+}
+
+/* run the search, pausing every few thousand guesses to checkpoint on time or on interruption
+ * returns 1 solved, 0 no solution or -1 interrupted with the last checkpoint written
+ */
+int run_checkpoint(search_t *search, checkpoint_t *checkpoint, double every)
+{
+    struct timespec last, now;
+    int state;
+
+    signal(SIGINT, on_interrupt);
+    signal(SIGTERM, on_interrupt);
+    clock_gettime(CLOCK_MONOTONIC, &last);
+    do {
+        search->pause = search->nodes + 4096;
+        state = search_run(search);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (state == -1 && (now.tv_sec - last.tv_sec) + (now.tv_nsec - last.tv_nsec) / 1e9 >= every) {
+            /* skipped if the last one is still being written */
+            if (checkpoint_save(checkpoint, search)) {
+                last = now;
+            }
+        }
+    } while (state == -1 && !interrupted);
+    search->pause = 0;
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    if (state == -1) {
+        /* the final checkpoint can't be skipped */
+        checkpoint_wait(checkpoint);
+        checkpoint_save(checkpoint, search);
+        if (!checkpoint_wait(checkpoint)) {
+            printf("[error] failed to write %s\n", checkpoint->path);
+        }
+    }
+    return state;
+}
+
+/* enumerate puzzle argv[2] into file argv[3] */
+int run_enumerate(int argc, char **argv)
+{
+    long limit = atol(option_value(argc, argv, "--limit", "0"));
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    int threads = atoi(option_value(argc, argv, "--threads", "1"));
+    int split = atoi(option_value(argc, argv, "--split", "2"));
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    puzzle_t *puzzle = puzzle_read_data(argv[2]);
+    if (puzzle == NULL) {
+        return 1;
+    }
+    char *probe = malloc(corpus_length(format, puzzle->size) + 1);
+    int fits = corpus_print(probe, format, puzzle->map, puzzle->scale, puzzle->size);
+    free(probe);
+    if (!fits) {
+        printf("[error] scale %d doesn't fit the format\n", puzzle->scale);
+        return 1;
+    }
+    FILE *pf = fopen(argv[3], "w");
+    if (pf == NULL) {
+        printf("[error] failed to write %s\n", argv[3]);
+        return 1;
+    }
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long count = enumerate_main(puzzle, pf, format, limit, threads, split);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    fclose(pf);
+
+    if (count < 0) {
+        printf("[error] scale %d is too large for enumerate\n", puzzle->scale);
+        return 1;
+    }
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("[okey] %ld solutions written to %s in %.3f s\n", count, argv[3], seconds);
+    return 0;
+}
+
+/* split, work, merge or distribute with the job directory in argv */
+int run_distribute(int argc, char **argv)
+{
+    int split = atoi(option_value(argc, argv, "--split", "2"));
+    int workers = atoi(option_value(argc, argv, "--workers", "4"));
+    long limit = atol(option_value(argc, argv, "--limit", "0"));
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    char *emit = option_value(argc, argv, "--emit", "count");
+    char *dir = !strcmp(argv[1], "work") || !strcmp(argv[1], "merge") ? argv[2] : argv[3];
+    int missing;
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    if (strcmp(emit, "count") && strcmp(emit, "solutions")) {
+        printf("[error] unknown result %s\n", emit);
+        return 1;
+    }
+    int emitted = !strcmp(emit, "solutions") ? DISTRIBUTE_SOLUTIONS : DISTRIBUTE_COUNT;
+
+    if (!strcmp(argv[1], "split") || !strcmp(argv[1], "distribute")) {
+        puzzle_t *puzzle = puzzle_read_data(argv[2]);
+        if (puzzle == NULL) {
+            return 1;
+        }
+        int jobs = distribute_split(puzzle, dir, split);
+        if (jobs < 0) {
+            printf("[error] failed to split into %s\n", dir);
+            return 1;
+        }
+        printf("[okey] %d jobs written to %s\n", jobs, dir);
+    }
+
+    if (!strcmp(argv[1], "work")) {
+        long stale = option_flag(argc, argv, "--reclaim") ? -1 : atol(option_value(argc, argv, "--stale", "0"));
+        int run = distribute_work(dir, emitted, format, limit, stale);
+        printf("[okey] %d jobs run\n", run);
+    }
+    else if (!strcmp(argv[1], "distribute")) {
+        struct timespec start, stop;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        long count = distribute_local(dir, workers, emitted, format, limit);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+        printf("[okey] %ld solutions found by %d workers in %.3f s\n", count, workers, seconds);
+    }
+    else if (!strcmp(argv[1], "merge")) {
+        FILE *pf = NULL;
+        if (argc >= 4 && argv[3][0] != '-') {
+            pf = fopen(argv[3], "w");
+            if (pf == NULL) {
+                printf("[error] failed to write %s\n", argv[3]);
+                return 1;
+            }
+        }
+        long count = distribute_merge(dir, pf, &missing);
+        if (pf != NULL) {
+            fclose(pf);
+        }
+        if (missing) {
+            printf("[error] %d jobs have no result yet\n", missing);
+        }
+        printf("[okey] %ld solutions in the results of %s\n", count, dir);
+        return missing != 0;
+    }
+
+    return 0;
+}
+
+int compare_double(const void *a, const void *b)
+{
+    double x = *(double *)a, y = *(double *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* solve the puzzles of corpus argv[2] by slices in turn, and report their latency */
+int run_schedule(int argc, char **argv)
+{
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    long slice = atol(option_value(argc, argv, "--slice", "100"));
+    int inflight = atoi(option_value(argc, argv, "--inflight", "1000"));
+    struct timespec now;
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    FILE *pf = fopen(argv[2], "r");
+    if (pf == NULL) {
+        printf("[error] failed to read %s\n", argv[2]);
+        return 1;
+    }
+    if (inflight < 1) {
+        inflight = 1;
+    }
+
+    schedule_t *schedule = schedule_create(inflight, slice);
+    char *line = NULL;
+    size_t capacity = 0;
+    cell_t map[10000];
+    double *starts = NULL, *latencies = NULL;
+    long total = 0, finished = 0, solved = 0, broken = 0, steps = 0;
+    int reading = 1;
+
+    while (reading || schedule->count > 0) {
+        /* keep the round full */
+        while (reading && schedule->count < inflight) {
+            if (getline(&line, &capacity, pf) == -1) {
+                reading = 0;
+                break;
+            }
+            int size = corpus_parse(line, format, map, 10000);
+            int order = size > 0 ? corpus_order(size) : 0;
+            puzzle_t puzzle = {
+                .order = order,
+                .scale = order * order,
+                .size = size,
+                .map = map
+            };
+            task_t *task = order > 0 ? task_create(&puzzle) : NULL;
+            if (task == NULL) {
+                broken++;
+                continue;
+            }
+            if (!option_search(argc, argv, task->search)) {
+                return 1;
+            }
+            if (total % 1024 == 0) {
+                starts = realloc(starts, sizeof(double) * (total + 1024));
+                latencies = realloc(latencies, sizeof(double) * (total + 1024));
+            }
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            starts[total] = now.tv_sec + now.tv_nsec / 1e9;
+            task->data = (void *)total;
+            total++;
+            schedule_add(schedule, task);
+        }
+
+        task_t *task = schedule_next(schedule);
+        if (task != NULL) {
+            long index = (long)task->data;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            latencies[finished++] = now.tv_sec + now.tv_nsec / 1e9 - starts[index];
+            solved += task->state == TASK_SOLVED;
+            steps += task->steps;
+            task_free(task);
+        }
+    }
+    fclose(pf);
+    free(line);
+    schedule_free(schedule);
+
+    if (broken) {
+        printf("[error] %ld lines are not puzzles\n", broken);
+    }
+    if (finished > 0) {
+        qsort(latencies, finished, sizeof(double), compare_double);
+        printf("[okey] %ld solved, %ld unsolvable in %ld steps\n", solved, finished - solved, steps);
+        printf("[okey] latency median %.6f s, p99 %.6f s, max %.6f s\n",
+            latencies[finished/2], latencies[finished*99/100], latencies[finished-1]);
+    }
+    free(starts);
+    free(latencies);
+    return 0;
+}
+
+/* solve the puzzles of corpus argv[2] by chunks and write them to corpus argv[3] */
+int run_batch(int argc, char **argv)
+{
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    char *engine = option_value(argc, argv, "--engine", "simd");
+    long route = atol(option_value(argc, argv, "--route", "0"));
+    char *hard = option_value(argc, argv, "--hard", NULL);
+    int probes = atoi(option_value(argc, argv, "--probes", "64"));
+    int chunk = 4096;
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    if (strcmp(engine, "simd") && strcmp(engine, "search")) {
+        printf("[error] unknown engine %s\n", engine);
+        return 1;
+    }
+    if (route > 0 && (hard == NULL || probes < 1)) {
+        printf("[error] routing needs --hard and at least one probe\n");
+        return 1;
+    }
+    /* the heuristics of the search, kept in a search over an empty grid */
+    cell_t empty[81] = {0};
+    puzzle_t blank = {3, 9, 81, empty};
+    search_t *settings = search_create(&blank);
+    if (!option_search(argc, argv, settings)) {
+        return 1;
+    }
+    FILE *pin = fopen(argv[2], "r");
+    if (pin == NULL) {
+        printf("[error] failed to read %s\n", argv[2]);
+        return 1;
+    }
+    FILE *pout = fopen(argv[3], "w");
+    if (pout == NULL) {
+        printf("[error] failed to write %s\n", argv[3]);
+        return 1;
+    }
+    FILE *phard = NULL;
+    if (route > 0) {
+        phard = fopen(hard, "w");
+        if (phard == NULL) {
+            printf("[error] failed to write %s\n", hard);
+            return 1;
+        }
+    }
+
+    puzzle_t **puzzles = malloc(sizeof(puzzle_t *) * chunk);
+    for (int p = 0; p < chunk; p++) {
+        puzzles[p] = malloc(sizeof(puzzle_t));
+        puzzles[p]->map = malloc(sizeof(cell_t) * 10000);
+    }
+    char *text = malloc(corpus_length(format, 10000));
+    char *line = NULL;
+    size_t capacity = 0;
+    /* the broken lines of a chunk and the count of puzzles before each, echoed in place */
+    char **echoes = malloc(sizeof(char *) * chunk);
+    int *echoed = malloc(sizeof(int) * chunk);
+    int *kept_before = malloc(sizeof(int) * (chunk + 1));
+    batch_stats_t stats = {0};
+    long solved = 0, broken = 0, routed = 0;
+    double seconds = 0, routing = 0;
+    struct timespec start, stop;
+
+    while (1) {
+        int count = 0, echoes_count = 0;
+        while (count < chunk && echoes_count < chunk && getline(&line, &capacity, pin) != -1) {
+            puzzle_t *puzzle = puzzles[count];
+            puzzle->size = corpus_parse(line, format, puzzle->map, 10000);
+            puzzle->order = puzzle->size > 0 ? corpus_order(puzzle->size) : 0;
+            puzzle->scale = puzzle->order * puzzle->order;
+            if (puzzle->order == 0) {
+                echoes[echoes_count] = strdup(line);
+                echoed[echoes_count++] = count;
+                broken++;
+                continue;
+            }
+            count++;
+        }
+        if (count == 0 && echoes_count == 0) {
+            break;
+        }
+
+        /* the puzzles estimated over route guesses go to another queue, the others stay in order */
+        if (route > 0) {
+            int kept = 0;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (int p = 0; p < count; p++) {
+                puzzle_t *puzzle = puzzles[p];
+                kept_before[p] = kept;
+                estimate_t *estimate = estimate_create(puzzle);
+                int away = 0;
+                if (estimate != NULL) {
+                    /* the guesses of this search to its first solution, not of the whole tree */
+                    search_configure(estimate->search, settings);
+                    estimate->first = 1;
+                    estimate->limit = probes;
+                    estimate_run(estimate);
+                    away = estimate->nodes > route;
+                    estimate_free(estimate);
+                }
+                if (away) {
+                    int length = corpus_print(text, format, puzzle->map, puzzle->scale, puzzle->size);
+                    fwrite(text, 1, length, phard);
+                    routed++;
+                }
+                else {
+                    puzzles[p] = puzzles[kept];
+                    puzzles[kept++] = puzzle;
+                }
+            }
+            kept_before[count] = kept;
+            for (int e = 0; e < echoes_count; e++) {
+                echoed[e] = kept_before[echoed[e]];
+            }
+            count = kept;
+            clock_gettime(CLOCK_MONOTONIC, &stop);
+            routing += (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (!strcmp(engine, "simd")) {
+            solved += batch_solve(puzzles, count, &stats);
+        }
+        else {
+            for (int p = 0; p < count; p++) {
+                search_t *search = search_create(puzzles[p]);
+                if (search != NULL) {
+                    search_configure(search, settings);
+                }
+                if (search != NULL && search_run(search) == 1) {
+                    memcpy(puzzles[p]->map, search->map, sizeof(cell_t) * puzzles[p]->size);
+                    solved++;
+                }
+                if (search != NULL) {
+                    search_free(search);
+                }
+            }
+            stats.puzzles += count;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        seconds += (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+
+        int e = 0;
+        for (int p = 0; p <= count; p++) {
+            for (; e < echoes_count && echoed[e] == p; e++) {
+                fputs(echoes[e], pout);
+                if (echoes[e][0] == '\0' || echoes[e][strlen(echoes[e])-1] != '\n') {
+                    fputc('\n', pout);
+                }
+                free(echoes[e]);
+            }
+            if (p == count) {
+                break;
+            }
+            int length = corpus_print(text, format, puzzles[p]->map, puzzles[p]->scale, puzzles[p]->size);
+            fwrite(text, 1, length, pout);
+        }
+    }
+    fclose(pin);
+    fclose(pout);
+
+    if (broken) {
+        printf("[error] %ld lines are not puzzles, echoed in place\n", broken);
+    }
+    if (phard != NULL) {
+        fclose(phard);
+        printf("[okey] %ld puzzles estimated over %ld guesses routed to %s in %.6f s\n", routed, route, hard, routing);
+    }
+    printf("[okey] %ld of %ld puzzles solved in %.6f s, %.0f puzzles per second\n",
+        solved, stats.puzzles, seconds, seconds > 0 ? stats.puzzles / seconds : 0);
+    if (!strcmp(engine, "simd")) {
+        printf("[okey] %ld by propagation in %ld lockstep rounds, %ld by search, %ld unsolvable\n",
+            stats.propagated, stats.rounds, stats.fallbacks, stats.unsolvable);
+    }
+
+    for (int p = 0; p < chunk; p++) {
+        free(puzzles[p]->map);
+        free(puzzles[p]);
+    }
+    free(puzzles);
+    search_free(settings);
+    free(echoes);
+    free(echoed);
+    free(kept_before);
+    free(text);
+    free(line);
+    return 0;
+}
+
+/* write random complete grids to corpus argv[2] */
+int run_generate(int argc, char **argv)
+{
+    int order = atoi(option_value(argc, argv, "--order", "3"));
+    long count = atol(option_value(argc, argv, "--count", "1000"));
+    int threads = atoi(option_value(argc, argv, "--threads", "1"));
+    char *name = option_value(argc, argv, "--format", "line");
+    int packed = !strcmp(name, "archive");
+    int format = packed ? CORPUS_LINE : corpus_format(name);
+    char *given = option_value(argc, argv, "--seed", NULL);
+    unsigned long long seed = given != NULL ? strtoull(given, NULL, 10) : (unsigned long long)time(0);
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    if (order < 2 || order > 11) {
+        printf("[error] order %d is out of 2 to 11\n", order);
+        return 1;
+    }
+    if (format == CORPUS_COMPACT && order > 9) {
+        printf("[error] scale %d doesn't fit the format\n", order * order);
+        return 1;
+    }
+    FILE *pf = NULL;
+    archive_t *archive = NULL;
+    if (packed) {
+        archive = archive_create(argv[2], order);
+    }
+    else {
+        pf = fopen(argv[2], "w");
+    }
+    if (pf == NULL && archive == NULL) {
+        printf("[error] failed to write %s\n", argv[2]);
+        return 1;
+    }
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (packed) {
+        generate_archive(order, archive, count, threads, seed);
+        if (!archive_close(archive)) {
+            printf("[error] failed to write %s\n", argv[2]);
+            return 1;
+        }
+    }
+    else {
+        generate_main(order, pf, format, count, threads, seed);
+        fclose(pf);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("[okey] %ld grids of order %d written to %s in %.3f s, %.0f grids per second, seed %llu\n",
+        count, order, argv[2], seconds, count / seconds, seed);
+    return 0;
+}
+
+/* climb for puzzles hard to the search in options, and append them to corpus argv[2] */
+int run_adversary(int argc, char **argv)
+{
+    int order = atoi(option_value(argc, argv, "--order", "3"));
+    long climbs = atol(option_value(argc, argv, "--climbs", "10"));
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    char *fitness = option_value(argc, argv, "--fitness", "nodes");
+    double keep = atof(option_value(argc, argv, "--keep", "0"));
+    char *given = option_value(argc, argv, "--start", NULL);
+    unsigned long long start = given != NULL ? strtoull(given, NULL, 10) : (unsigned long long)time(0);
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    if (strcmp(fitness, "nodes") && strcmp(fitness, "time")) {
+        printf("[error] unknown fitness %s\n", fitness);
+        return 1;
+    }
+    if (order < 2 || order > 11 || (format == CORPUS_COMPACT && order > 9)) {
+        printf("[error] order %d doesn't fit\n", order);
+        return 1;
+    }
+    /* the settings are kept in a search over an empty grid */
+    cell_t *empty = calloc(order * order * order * order, sizeof(cell_t));
+    puzzle_t blank = {order, order * order, order * order * order * order, empty};
+    search_t *settings = search_create(&blank);
+    if (!option_search(argc, argv, settings)) {
+        return 1;
+    }
+    adversary_t *adv = adversary_create(order, settings);
+    adv->fitness = !strcmp(fitness, "time") ? ADVERSARY_TIME : ADVERSARY_NODES;
+    adv->unique = atoi(option_value(argc, argv, "--unique", "1"));
+    adv->steps = atol(option_value(argc, argv, "--steps", "1000"));
+    adv->limit = atol(option_value(argc, argv, "--limit", "1000000"));
+
+    /* appended, so the corpus of killers grows run by run */
+    FILE *pf = fopen(argv[2], "a");
+    if (pf == NULL) {
+        printf("[error] failed to write %s\n", argv[2]);
+        return 1;
+    }
+    char *text = malloc(corpus_length(format, adv->size) + 1);
+    long kept = 0;
+    for (long c = 0; c < climbs; c++) {
+        double score = adversary_climb(adv, start + c);
+        int clues = 0;
+        for (int i = 0; i < adv->size; i++) {
+            clues += adv->best[i] != 0;
+        }
+        printf("[okey] climb %llu: %d clues, %s %g\n", start + c, clues, fitness, score);
+        if (score >= keep) {
+            fwrite(text, 1, corpus_print(text, format, adv->best, adv->scale, adv->size), pf);
+            fflush(pf);
+            kept++;
+        }
+    }
+    fclose(pf);
+    printf("[okey] %ld puzzles appended to %s, %ld puzzles measured\n", kept, argv[2], adv->evaluated);
+
+    free(text);
+    adversary_free(adv);
+    search_free(settings);
+    free(empty);
+    return 0;
+}
+
+/* solve the puzzles of corpus argv[2] one by one by the engine in options, and report the spread */
+int run_bench(int argc, char **argv)
+{
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    char *engine = option_value(argc, argv, "--engine", "search");
+    int overlaid = !strcmp(engine, "overlay");
+    struct timespec start, stop;
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    if (!overlaid && strcmp(engine, "search")) {
+        printf("[error] unknown engine %s\n", engine);
+        return 1;
+    }
+    if (overlaid) {
+        /* the table of templates is built once for all puzzles */
+        overlay_templates();
+    }
+    FILE *pf = fopen(argv[2], "r");
+    if (pf == NULL) {
+        printf("[error] failed to read %s\n", argv[2]);
+        return 1;
+    }
+
+    char *line = NULL;
+    size_t capacity = 0;
+    cell_t map[10000];
+    double *nodes = NULL, *seconds = NULL;
+    long total = 0, solved = 0, broken = 0, lines = 0, worst = 0;
+    double worstnodes = -1;
+
+    while (getline(&line, &capacity, pf) != -1) {
+        lines++;
+        int size = corpus_parse(line, format, map, 10000);
+        int order = size > 0 ? corpus_order(size) : 0;
+        puzzle_t puzzle = {
+            .order = order,
+            .scale = order * order,
+            .size = size,
+            .map = map
+        };
+        /* timed with the engine built, as the overlay builds its lists of templates there */
+        search_t *search = NULL;
+        overlay_t *overlay = NULL;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (order > 0) {
+            if (overlaid) {
+                overlay = overlay_create(&puzzle);
+            }
+            else {
+                search = search_create(&puzzle);
+            }
+        }
+        if (search == NULL && overlay == NULL) {
+            broken++;
+            continue;
+        }
+        if (search != NULL && !option_search(argc, argv, search)) {
+            return 1;
+        }
+        if (total % 1024 == 0) {
+            nodes = realloc(nodes, sizeof(double) * (total + 1024));
+            seconds = realloc(seconds, sizeof(double) * (total + 1024));
+        }
+        solved += search != NULL ? search_run(search) == 1 : overlay_run(overlay);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        seconds[total] = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+        nodes[total] = search != NULL ? search->nodes : overlay->nodes;
+        if (nodes[total] > worstnodes) {
+            worstnodes = nodes[total];
+            worst = lines;
+        }
+        total++;
+        if (search != NULL) {
+            search_free(search);
+        }
+        else {
+            overlay_free(overlay);
+        }
+    }
+    fclose(pf);
+    free(line);
+
+    if (broken) {
+        printf("[error] %ld lines are not puzzles\n", broken);
+    }
+    if (total > 0) {
+        double sum = 0;
+        for (long i = 0; i < total; i++) {
+            sum += seconds[i];
+        }
+        qsort(nodes, total, sizeof(double), compare_double);
+        qsort(seconds, total, sizeof(double), compare_double);
+        printf("[okey] %ld solved, %ld unsolvable in %.6f s\n", solved, total - solved, sum);
+        printf("[okey] %s median %.0f, p90 %.0f, p99 %.0f, p99.9 %.0f, max %.0f at line %ld\n",
+            overlaid ? "templates" : "guesses", nodes[total/2], nodes[total*9/10], nodes[total*99/100],
+            nodes[total*999/1000], nodes[total-1], worst);
+        printf("[okey] time median %.6f s, p90 %.6f s, p99 %.6f s, p99.9 %.6f s, max %.6f s\n",
+            seconds[total/2], seconds[total*9/10], seconds[total*99/100], seconds[total*999/1000], seconds[total-1]);
+    }
+    free(nodes);
+    free(seconds);
+    return 0;
+}
+
+/* estimate the guesses and time of the search on puzzle argv[2] by random probes */
+int run_estimate(int argc, char **argv)
+{
+    puzzle_t *puzzle = puzzle_read_data(argv[2]);
+    if (puzzle == NULL) {
+        return 1;
+    }
+    estimate_t *estimate = estimate_create(puzzle);
+    if (estimate == NULL) {
+        printf("[error] scale %d is too large for search\n", puzzle->scale);
+        return 1;
+    }
+    if (!option_search(argc, argv, estimate->search)) {
+        return 1;
+    }
+    estimate->limit = atoi(option_value(argc, argv, "--probes", "64"));
+    estimate->budget = atof(option_value(argc, argv, "--time", "1"));
+    estimate->seed = strtoull(option_value(argc, argv, "--seed", "0"), NULL, 10);
+    estimate->first = option_flag(argc, argv, "--first");
+    if (estimate->limit < 1) {
+        printf("[error] an estimate needs at least one probe\n");
+        return 1;
+    }
+
+    estimate_run(estimate);
+    printf("[okey] %d probes in %.6f s, %d reached a solution, %d guesses deep at most\n",
+        estimate->probes, estimate->spent, estimate->solutions, estimate->deepest);
+    char *goal = estimate->first ? "to the first solution" : "to exhaust the tree";
+    printf("[okey] %.3g guesses %s, 95%% within %.3g to %.3g\n",
+        estimate->nodes, goal, estimate->low, estimate->high);
+    printf("[okey] %.3g s %s, 95%% within %.3g to %.3g\n",
+        estimate->seconds, goal, (estimate->low + 1) * estimate->pernode, (estimate->high + 1) * estimate->pernode);
+    estimate_free(estimate);
+    return 0;
+}
+
+/* count the completions of puzzle argv[2] by the search, or exactly by symmetry-reduced rows */
+int run_count(int argc, char **argv)
+{
+    int exact = option_flag(argc, argv, "--exact");
+    int check = option_flag(argc, argv, "--check");
+    char text[COUNT_DIGITS];
+    struct timespec start, stop;
+    count_total_t total = 0;
+
+    puzzle_t *puzzle = puzzle_read_data(argv[2]);
+    if (puzzle == NULL) {
+        return 1;
+    }
+    if (exact) {
+        count_t *count = count_create(puzzle);
+        if (count == NULL) {
+            printf("[error] scale %d is too large for count\n", puzzle->scale);
+            return 1;
+        }
+        count->limit = atol(option_value(argc, argv, "--states", "4000000"));
+        int ok = count_exact(count);
+        if (ok == 0) {
+            printf("[error] more than 2^128 completions, counting stopped after %.3f s\n", count->seconds);
+        }
+        else if (ok == -1) {
+            printf("[error] more than %ld states after row %d, counting stopped after %.3f s\n",
+                count->limit, count->stopped + 1, count->seconds);
+        }
+        if (ok != 1) {
+            count_free(count);
+            return 1;
+        }
+        total = count->total;
+        count_print(text, total);
+        printf("[okey] %s completions counted exactly in %.3f s\n", text, count->seconds);
+        printf("[okey] %ld canonical states, %ld after the widest row, %ld rows filled\n",
+            count->states, count->widest, count->fillings);
+        count_free(count);
+        if (!check) {
+            return 0;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long found = count_search(puzzle);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (found < 0) {
+        printf("[error] scale %d is too large for search\n", puzzle->scale);
+        return 1;
+    }
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("[okey] %ld completions counted by the search in %.3f s\n", found, seconds);
+    if (exact) {
+        if (total != (count_total_t)found) {
+            printf("[error] the counts differ\n");
+            return 1;
+        }
+        printf("[okey] the counts agree\n");
+    }
+    return 0;
+}
+
+/* print the invalid ones of a chunk of results, first at line index + 1 */
+void report_invalid(int *results, int count, long index)
+{
+    static const char *reasons[] = {"valid", "a number twice in a unit", "a number out of scale", "a void"};
+
+    for (int p = 0; p < count; p++) {
+        if (results[p] != VALIDATE_OK) {
+            printf("[error] grid %ld: %s\n", index + p + 1, reasons[results[p]]);
+        }
+    }
+}
+
+/* check the grids of corpus argv[2] by chunks, and report every invalid one */
+int run_validate(int argc, char **argv)
+{
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    int complete = atoi(option_value(argc, argv, "--complete", "1"));
+    int chunk = 4096;
+    int block = 1 << 22;
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    archive_t *archive = archive_open(argv[2]);
+    if (archive != NULL) {
+        return validate_archive(archive, complete);
+    }
+    FILE *pf = fopen(argv[2], "r");
+    if (pf == NULL) {
+        printf("[error] failed to read %s\n", argv[2]);
+        return 1;
+    }
+
+    int *results = malloc(sizeof(int) * chunk);
+    long total = 0, valid = 0, bytes = 0;
+    struct timespec start, stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (format == CORPUS_COMPACT) {
+        /* lines are checked where they are read, a block at a time */
+        char *buffer = malloc(block);
+        char **lines = malloc(sizeof(char *) * chunk);
+        int *lengths = malloc(sizeof(int) * chunk);
+        size_t kept = 0, got;
+        int count = 0;
+
+        while ((got = fread(buffer + kept, 1, block - kept, pf)) > 0 || kept > 0) {
+            size_t filled = kept + got;
+            char *at = buffer, *end = buffer + filled;
+            bytes += got;
+            while (at < end) {
+                char *newline = memchr(at, '\n', end - at);
+                if (newline == NULL) {
+                    if (got > 0 && at != buffer) {
+                        break;
+                    }
+                    /* the last line without a line end, or a line longer than the block */
+                    newline = end;
+                }
+                int length = newline - at;
+                if (length > 0 && at[length-1] == '\r') {
+                    length--;
+                }
+                lines[count] = at;
+                lengths[count++] = length;
+                at = newline + 1;
+                if (count == chunk) {
+                    valid += validate_compact(lines, lengths, count, complete, results);
+                    report_invalid(results, count, total);
+                    total += count;
+                    count = 0;
+                }
+            }
+            if (count > 0) {
+                valid += validate_compact(lines, lengths, count, complete, results);
+                report_invalid(results, count, total);
+                total += count;
+                count = 0;
+            }
+            kept = at < end ? end - at : 0;
+            memmove(buffer, at < end ? at : end, kept);
+        }
+        free(buffer);
+        free(lines);
+        free(lengths);
+    }
+    else {
+        puzzle_t **puzzles = malloc(sizeof(puzzle_t *) * chunk);
+        for (int p = 0; p < chunk; p++) {
+            puzzles[p] = malloc(sizeof(puzzle_t));
+            puzzles[p]->map = malloc(sizeof(cell_t) * 10000);
+        }
+        char *line = NULL;
+        size_t capacity = 0;
+        ssize_t length = 0;
+
+        while (length != -1) {
+            int count = 0;
+            while (count < chunk && (length = getline(&line, &capacity, pf)) != -1) {
+                puzzle_t *puzzle = puzzles[count++];
+                bytes += length;
+                puzzle->size = corpus_parse(line, format, puzzle->map, 10000);
+                puzzle->order = puzzle->size > 0 ? corpus_order(puzzle->size) : 0;
+                puzzle->scale = puzzle->order * puzzle->order;
+                /* not a grid, so nothing is in scale */
+                if (puzzle->order == 0) {
+                    puzzle->order = 1;
+                    puzzle->scale = 1;
+                    puzzle->size = 1;
+                    puzzle->map[0] = PUZZLE_CELLMAX;
+                }
+            }
+            valid += validate_puzzles(puzzles, count, complete, results);
+            report_invalid(results, count, total);
+            total += count;
+        }
+        for (int p = 0; p < chunk; p++) {
+            free(puzzles[p]->map);
+            free(puzzles[p]);
+        }
+        free(puzzles);
+        free(line);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    fclose(pf);
+
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("[okey] %ld of %ld grids valid, %ld invalid\n", valid, total, total - valid);
+    printf("[okey] checked in %.6f s, %.0f grids per second, %.1f MB per second\n",
+        seconds, seconds > 0 ? total / seconds : 0, seconds > 0 ? bytes / seconds / 1e6 : 0);
+
+    free(results);
+    return total == valid ? 0 : 2;
+}
+
+/* check the grids of an archive block by block; broken blocks count as invalid grids */
+int validate_archive(archive_t *archive, int complete)
+{
+    int size = archive->codec->size;
+    cell_t *maps = malloc(sizeof(cell_t) * size * ARCHIVE_BLOCK);
+    int *results = malloc(sizeof(int) * ARCHIVE_BLOCK);
+    puzzle_t *lanes = malloc(sizeof(puzzle_t) * ARCHIVE_BLOCK);
+    puzzle_t **puzzles = malloc(sizeof(puzzle_t *) * ARCHIVE_BLOCK);
+    long total = 0, valid = 0;
+    struct timespec start, stop;
+
+    for (int p = 0; p < ARCHIVE_BLOCK; p++) {
+        lanes[p] = (puzzle_t){archive->codec->order, archive->codec->scale, size, maps + (long)size * p};
+        puzzles[p] = lanes + p;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long b = 0; b < archive->blocks; b++) {
+        int count = archive_read(archive, b, maps);
+        if (count < 0) {
+            printf("[error] block %ld: broken, %d grids lost\n", b, archive->counts[b]);
+            total += archive->counts[b];
+            continue;
+        }
+        valid += validate_puzzles(puzzles, count, complete, results);
+        report_invalid(results, count, total);
+        total += count;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    double bytes = archive->offsets[archive->blocks];
+    printf("[okey] %ld of %ld grids valid, %ld invalid\n", valid, total, total - valid);
+    printf("[okey] checked in %.6f s, %.0f grids per second, %.1f MB per second\n",
+        seconds, seconds > 0 ? total / seconds : 0, seconds > 0 ? bytes / seconds / 1e6 : 0);
+
+    free(maps);
+    free(results);
+    free(lanes);
+    free(puzzles);
+    archive_close(archive);
+    return total == valid ? 0 : 2;
+}
+
+/* pack corpus argv[2] into archive argv[3], or unpack archive argv[2] into corpus argv[3] */
+int run_archive(int argc, char **argv)
+{
+    int format = corpus_format(option_value(argc, argv, "--format", "line"));
+    long only = atol(option_value(argc, argv, "--block", "-1"));
+    int packing = !strcmp(argv[1], "pack");
+    long grids = 0, bytes = 0;
+    struct timespec start, stop;
+
+    if (format == -1) {
+        printf("[error] unknown format\n");
+        return 1;
+    }
+    FILE *pf = fopen(argv[packing ? 2 : 3], packing ? "r" : "w");
+    if (pf == NULL) {
+        printf("[error] failed to %s %s\n", packing ? "read" : "write", argv[packing ? 2 : 3]);
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (packing) {
+        archive_t *archive = NULL;
+        cell_t *map = malloc(sizeof(cell_t) * 10000);
+        char *line = NULL;
+        size_t capacity = 0;
+        ssize_t length;
+        long index = 0;
+
+        while ((length = getline(&line, &capacity, pf)) != -1) {
+            int size = corpus_parse(line, format, map, 10000);
+            int order = size > 0 ? corpus_order(size) : 0;
+            bytes += length;
+            index++;
+            /* the first grid decides the order of the archive */
+            if (archive == NULL && order >= 2) {
+                archive = archive_create(argv[3], order);
+                if (archive == NULL) {
+                    printf("[error] failed to write %s\n", argv[3]);
+                    break;
+                }
+            }
+            if (archive == NULL || order != archive->codec->order || !archive_write(archive, map)) {
+                printf("[error] grid %ld: not a complete grid of the archive, skipped\n", index);
+                continue;
+            }
+            grids++;
+        }
+        free(line);
+        free(map);
+        fclose(pf);
+        if (archive == NULL) {
+            printf("[error] no grid to pack\n");
+            return 1;
+        }
+        long blocks = archive->blocks + (archive->waiting > 0);
+        if (!archive_close(archive)) {
+            printf("[error] failed to write %s\n", argv[3]);
+            return 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        pf = fopen(argv[3], "rb");
+        fseek(pf, 0, SEEK_END);
+        long packed = ftell(pf);
+        fclose(pf);
+        double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+        printf("[okey] %ld grids packed in %ld blocks, %ld bytes to %ld bytes, %.2f bits per grid\n",
+            grids, blocks, bytes, packed, grids > 0 ? packed * 8.0 / grids : 0);
+        printf("[okey] packed in %.3f s, %.0f grids per second, %.1f times smaller\n",
+            seconds, seconds > 0 ? grids / seconds : 0, packed > 0 ? (double)bytes / packed : 0);
+        return 0;
+    }
+
+    archive_t *archive = archive_open(argv[2]);
+    if (archive == NULL) {
+        printf("[error] %s is not an archive\n", argv[2]);
+        fclose(pf);
+        return 1;
+    }
+    archive_codec_t *codec = archive->codec;
+    cell_t *maps = malloc(sizeof(cell_t) * codec->size * ARCHIVE_BLOCK);
+    char *text = malloc((long)corpus_length(format, codec->size) * ARCHIVE_BLOCK);
+    int broken = 0;
+
+    /* a block alone is read without the ones before it */
+    long first = only >= 0 ? only : 0;
+    long last = only >= 0 ? only + 1 : archive->blocks;
+    for (long b = first; b < last; b++) {
+        int count = archive_read(archive, b, maps);
+        if (count < 0) {
+            printf("[error] block %ld is broken or missing\n", b);
+            broken = 1;
+            continue;
+        }
+        long used = 0;
+        for (int k = 0; k < count; k++) {
+            int length = corpus_print(text + used, format, maps + (long)codec->size * k, codec->scale, codec->size);
+            if (length == 0) {
+                printf("[error] scale %d doesn't fit the format\n", codec->scale);
+                broken = 1;
+                break;
+            }
+            used += length;
+        }
+        fwrite(text, 1, used, pf);
+        bytes += used;
+        grids += count;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    fclose(pf);
+
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("[okey] %ld grids of order %d unpacked to %s, %ld bytes\n", grids, codec->order, argv[3], bytes);
+    printf("[okey] unpacked in %.3f s, %.0f grids per second\n", seconds, seconds > 0 ? grids / seconds : 0);
+
+    free(maps);
+    free(text);
+    archive_close(archive);
+    return broken;
+}
+
+/* solve the puzzle of argv[2], sampling the stages of the solvers with --profile */
+int run_solve(int argc, char **argv)
+{
+    char *path = option_value(argc, argv, "--profile", NULL);
+    char *format = option_value(argc, argv, "--profile-format", "folded");
+    int hz = atoi(option_value(argc, argv, "--profile-hz", "1000"));
+
+    if (path == NULL) {
+        return solve_engine(argc, argv);
+    }
+    if (strcmp(format, "folded") && strcmp(format, "series")) {
+        printf("[error] unknown profile format %s\n", format);
+        return 1;
+    }
+    if (!profile_start(hz)) {
+        printf("[error] failed to sample at %d hz\n", hz);
+        return 1;
+    }
+    int result = solve_engine(argc, argv);
+    long samples = profile_stop(path, !strcmp(format, "series") ? PROFILE_SERIES : PROFILE_FOLDED);
+    if (samples == -1) {
+        printf("[error] failed to write %s\n", path);
+        return 1;
+    }
+    printf("[okey] %ld samples written to %s:", samples, path);
+    for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+        long count = profile_samples(stage);
+        if (count > 0) {
+            printf(" %s %.1f%%", profile_name(stage), 100.0 * count / samples);
+        }
+    }
+    printf("\n");
+    return result;
+}
+
+/* solve the puzzle of argv[2] by the engine of the options */
+int solve_engine(int argc, char **argv)
+{
+    char *engine = option_value(argc, argv, "--engine", "step");
+    char *given = option_value(argc, argv, "--portfolio", "4");
+    /* a bare --portfolio races 4 */
+    int racers = given[0] == '-' ? 4 : atoi(given);
+
+    if (option_flag(argc, argv, "--portfolio")) {
+        engine = "portfolio";
+    }
+    puzzle_t *puzzle = puzzle_read_data(argv[2]);
+    if (puzzle == NULL) {
+        return 1;
+    }
+    if (!strcmp(engine, "step")) {
+        char *mode = option_value(argc, argv, "--render", "full");
+        long interval = atol(option_value(argc, argv, "--interval", "0"));
+        if (strcmp(mode, "full") && strcmp(mode, "diff")) {
+            printf("[error] unknown render mode %s\n", mode);
+            return 1;
+        }
+        render_t *render = render_create(puzzle, !strcmp(mode, "diff") ? RENDER_DIFF : RENDER_FULL, interval * 1000);
+        solver_main(puzzle, render);
+        printf("[okey] %ld frames drawn, %ld skipped\n", render->frames, render->skipped);
+        render_free(render);
+        return 0;
+    }
+
+    int solved = 0, complete = 1;
+    cell_t *solution = malloc(sizeof(cell_t) * puzzle->size);
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!strcmp(engine, "search")) {
+        search_t *search = search_create(puzzle);
+        if (search == NULL) {
+            printf("[error] scale %d is too large for search\n", puzzle->scale);
+            return 1;
+        }
+        if (!option_search(argc, argv, search)) {
+            return 1;
+        }
+        char *resume = option_value(argc, argv, "--resume", NULL);
+        char *save = option_value(argc, argv, "--checkpoint", resume);
+        if (resume != NULL) {
+            if (!checkpoint_load(resume, search)) {
+                printf("[error] failed to resume from %s\n", resume);
+                return 1;
+            }
+            printf("[okey] resumed from %s at %d guesses deep after %ld guesses\n",
+                resume, search->guessed, search->nodes);
+        }
+        if (save != NULL) {
+            checkpoint_t *checkpoint = checkpoint_create(save, search);
+            solved = run_checkpoint(search, checkpoint, atof(option_value(argc, argv, "--every", "60")));
+            printf("[okey] %ld checkpoints written to %s, %ld skipped\n",
+                checkpoint->written, save, checkpoint->skipped);
+            checkpoint_free(checkpoint);
+            if (solved == -1) {
+                printf("[okey] interrupted, go on with --resume %s\n", save);
+                search_free(search);
+                return 0;
+            }
+        }
+        else {
+            solved = search_run(search);
+        }
+        memcpy(solution, search->map, sizeof(cell_t) * puzzle->size);
+        printf("[okey] %ld guesses, %ld drawbacks, %ld guesses jumped over, %d nogoods, %ld restarts\n",
+            search->nodes, search->drawbacks, search->jumps, search->totalnogood, search->restarts);
+        if (search->propagation == SEARCH_MATCHING) {
+            printf("[okey] %ld numbers banned by matching\n", search->matchbans);
+        }
+        search_free(search);
+    }
+    else if (!strcmp(engine, "portfolio")) {
+        if (racers < 1) {
+            printf("[error] a portfolio needs at least one strategy\n");
+            return 1;
+        }
+        portfolio_t *portfolio = portfolio_create(puzzle, racers,
+            strtoull(option_value(argc, argv, "--seed", "0"), NULL, 10));
+        if (portfolio == NULL) {
+            printf("[error] scale %d is too large for search\n", puzzle->scale);
+            return 1;
+        }
+        solved = portfolio_run(portfolio) == TASK_SOLVED;
+        for (int i = 0; i < portfolio->count; i++) {
+            portfolio_member_t *member = portfolio->members + i;
+            search_t *search = member->task->search;
+            printf("[okey] %d %-42s %-10s %ld guesses, %ld drawbacks, %ld jumped, %ld restarts in %.6f s\n",
+                i, member->name, i == portfolio->winner ? "first" : member->cancelled ? "cancelled" : "late",
+                search->nodes, search->drawbacks, search->jumps, search->restarts, member->seconds);
+        }
+        memcpy(solution, portfolio->members[portfolio->winner].task->search->map, sizeof(cell_t) * puzzle->size);
+        portfolio_free(portfolio);
+    }
+    else if (!strcmp(engine, "overlay")) {
+        overlay_t *overlay = overlay_create(puzzle);
+        if (overlay == NULL) {
+            printf("[error] the overlay engine takes 9x9 puzzles only\n");
+            return 1;
+        }
+        solved = overlay_run(overlay);
+        if (solved) {
+            memcpy(solution, overlay->map, sizeof(cell_t) * puzzle->size);
+        }
+        printf("[okey] %ld templates tried, %ld lists narrowed\n", overlay->nodes, overlay->narrows);
+        overlay_free(overlay);
+    }
+    else if (!strcmp(engine, "anneal")) {
+        int threads = atoi(option_value(argc, argv, "--threads", "1"));
+        if (threads < 1) {
+            printf("[error] annealing needs at least one chain\n");
+            return 1;
+        }
+        anneal_t *anneal = anneal_create(puzzle, threads,
+            strtoull(option_value(argc, argv, "--seed", "0"), NULL, 10));
+        if (anneal == NULL) {
+            printf("[error] the givens clash\n");
+            return 1;
+        }
+        anneal->seconds = atof(option_value(argc, argv, "--time", "60"));
+        anneal->handoff = atoi(option_value(argc, argv, "--handoff", "0"));
+        anneal->budget = atol(option_value(argc, argv, "--budget", "10000"));
+        solved = anneal_run(anneal);
+        for (int i = 0; i < anneal->count; i++) {
+            anneal_chain_t *chain = anneal->chains + i;
+            printf("[okey] %d %-8s cost %d best %d, %ld swaps, %ld rounds, %ld reheats, %ld handoffs in %.6f s\n",
+                i, i == anneal->winner ? (chain->finish == 2 ? "handoff" : "first") : chain->finish ? "late" : "unsolved",
+                chain->cost, chain->best, chain->moves, chain->rounds, chain->reheats, chain->handoffs, chain->seconds);
+        }
+        if (solved) {
+            memcpy(solution, anneal->solution, sizeof(cell_t) * puzzle->size);
+        }
+        complete = 0;
+        anneal_free(anneal);
+    }
+    else if (!strcmp(engine, "sat")) {
+        cnf_t *cnf = cnf_encode(puzzle);
+        sat_t *sat = cnf_load(cnf);
+        printf("[okey] %d variables and %d clauses encoded\n", cnf->totalvar, cnf->totalclause);
+        solved = sat_solve(sat);
+        if (solved) {
+            cnf_decode(cnf, sat, solution);
+        }
+        printf("[okey] %ld decisions, %ld conflicts, %ld restarts\n", sat->decisions, sat->conflicts, sat->restarts);
+        sat_free(sat);
+        cnf_free(cnf);
+    }
+    else {
+        printf("[error] unknown engine %s\n", engine);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+
+    if (solved) {
+        puzzle->map = solution;
+        puzzle_print_console(puzzle);
+        printf("[okey] sudoku solved in %.6f s\n", seconds);
+    }
+    else if (complete) {
+        printf("[error] no solution, proved in %.6f s\n", seconds);
+    }
+    else {
+        /* a local search that gives up has proved nothing */
+        printf("[error] no solution found in %.6f s, which proves nothing\n", seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: MIT License
+/* overlay.c -- the pattern overlay engine for 9x9 puzzles
+ * the search guesses per number instead of per cell. a number takes one cell of every row,
+ * col and chunk, so all of its places form one of 46656 templates, a set of 81 bits.
+ * every number starts with the templates holding its givens and none of the others', and
+ * a solution is nine templates not overlapping.
+ *
+ * before every guess the lists are narrowed by overlaying them: the cells common to all
+ * templates of a number are its for sure, so the other numbers drop templates touching
+ * them, and a free cell only one number can still reach must be that number's. then the
+ * number with the fewest templates is decided template by template, and the others keep
+ * only the templates missing it. all of it is and, or and compare on masks, with no notes
+ * of cells, so puzzles whose cells stay open long while the numbers are tightly pinned
+ * fall fast here and slow to guessing cells.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <overlay.h>
+#include <search.h>
+#include <puzzle.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static mask_t overlay_table[OVERLAY_TEMPLATES];
+static int overlay_ready = 0;
+
+/* place the number row by row on a col and chunk not used yet */
+static int overlay_build(int row, int cols, int chunks, mask_t cells, int count)
+{
+    if (row == OVERLAY_SCALE) {
+        overlay_table[count++] = cells;
+        return count;
+    }
+    for (int col = 0; col < OVERLAY_SCALE; col++) {
+        int chunk = row / 3 * 3 + col / 3;
+        if (!(cols >> col & 1) && !(chunks >> chunk & 1)) {
+            count = overlay_build(row + 1, cols | 1 << col, chunks | 1 << chunk,
+                cells | (mask_t)1 << (OVERLAY_SCALE * row + col), count);
+        }
+    }
+    return count;
+}
+
+const mask_t *overlay_templates()
+{
+    if (!overlay_ready) {
+        overlay_build(0, 0, 0, 0, 0);
+        overlay_ready = 1;
+    }
+    return overlay_table;
+}
+
+/* templates below a choice on every row, the same for any choices on the rows above */
+static const int overlay_below[OVERLAY_SCALE] = {5184, 864, 288, 48, 12, 6, 2, 1, 1};
+
+/* list the templates holding need and missing avoid in the order of the table, walking the rows
+ * and skipping every branch of a clash, so only the templates kept are visited
+ * returns the count listed
+ */
+static int overlay_list(int row, int cols, int chunks, int index, mask_t need, mask_t avoid,
+    unsigned short *list, int count)
+{
+    if (row == OVERLAY_SCALE) {
+        list[count++] = index;
+        return count;
+    }
+    int rank = 0;
+    for (int col = 0; col < OVERLAY_SCALE; col++) {
+        int chunk = row / 3 * 3 + col / 3;
+        if ((cols >> col & 1) || (chunks >> chunk & 1)) {
+            continue;
+        }
+        mask_t cell = (mask_t)1 << (OVERLAY_SCALE * row + col);
+        mask_t line = ((mask_t)0x1ff) << (OVERLAY_SCALE * row);
+        /* a given of the row leaves its col only */
+        if (!(avoid & cell) && (!(need & line) || (need & cell))) {
+            count = overlay_list(row + 1, cols | 1 << col, chunks | 1 << chunk,
+                index + rank * overlay_below[row], need, avoid, list, count);
+        }
+        rank++;
+    }
+    return count;
+}
+
+/* keep the templates of list holding need and missing avoid; returns the count kept */
+static int overlay_filter(unsigned short *from, int count, unsigned short *to, mask_t need, mask_t avoid)
+{
+    int kept = 0;
+
+    /* stored always and counted only if kept, so the loop doesn't branch */
+    for (int k = 0; k < count; k++) {
+        mask_t cells = overlay_table[from[k]];
+        to[kept] = from[k];
+        kept += (cells & need) == need && (cells & avoid) == 0;
+    }
+    return kept;
+}
+
+overlay_t *overlay_create(puzzle_t *puzzle)
+{
+    if (puzzle->scale != OVERLAY_SCALE) {
+        return NULL;
+    }
+    overlay_templates();
+
+    overlay_t *overlay = malloc(sizeof(overlay_t));
+    mask_t givens[OVERLAY_SCALE] = {0}, all = 0;
+    for (int i = 0; i < OVERLAY_SIZE; i++) {
+        int num = puzzle->map[i];
+        if (num >= 1 && num <= OVERLAY_SCALE) {
+            givens[num-1] |= (mask_t)1 << i;
+            all |= (mask_t)1 << i;
+        }
+    }
+
+    /* the lists of depth 0 first, then room for every deeper one as large */
+    unsigned short *first = malloc(sizeof(unsigned short) * OVERLAY_SCALE * OVERLAY_TEMPLATES);
+    long total = 0;
+    for (int n = 0; n < OVERLAY_SCALE; n++) {
+        overlay->levels[0].counts[n] = overlay_list(0, 0, 0, 0, givens[n], all & ~givens[n], first + total, 0);
+        total += overlay->levels[0].counts[n];
+    }
+    overlay->stride = total + 1;
+    overlay->pool = malloc(sizeof(unsigned short) * (OVERLAY_SCALE + 1) * overlay->stride);
+    memcpy(overlay->pool, first, sizeof(unsigned short) * total);
+    total = 0;
+    for (int n = 0; n < OVERLAY_SCALE; n++) {
+        overlay->levels[0].lists[n] = overlay->pool + total;
+        total += overlay->levels[0].counts[n];
+        overlay->picks[n] = -1;
+    }
+    free(first);
+
+    overlay->nodes = 0;
+    overlay->narrows = 0;
+    return overlay;
+}
+
+void overlay_free(overlay_t *overlay)
+{
+    free(overlay->pool);
+    free(overlay);
+}
+
+/* narrow the lists of depth by overlaying them until nothing changes
+ * returns 0 if a number is left with no template or a free cell with no number
+ */
+static int overlay_narrow(overlay_t *overlay, int depth, mask_t taken)
+{
+    overlay_level_t *level = overlay->levels + depth;
+    const mask_t full = ((mask_t)1 << OVERLAY_SIZE) - 1;
+    mask_t open = full & ~taken;
+    int changed = 1;
+
+    while (changed) {
+        mask_t unions[OVERLAY_SCALE], inters[OVERLAY_SCALE], once = 0, twice = 0, sure = 0;
+        changed = 0;
+        for (int n = 0; n < OVERLAY_SCALE; n++) {
+            if (overlay->picks[n] != -1) {
+                continue;
+            }
+            if (level->counts[n] == 0) {
+                return 0;
+            }
+            mask_t cup = 0, cap = full;
+            for (int k = 0; k < level->counts[n]; k++) {
+                mask_t cells = overlay_table[level->lists[n][k]];
+                cup |= cells;
+                cap &= cells;
+            }
+            unions[n] = cup;
+            inters[n] = cap;
+            twice |= once & cup;
+            once |= cup;
+            sure |= cap;
+        }
+        if (open & ~once) {
+            return 0;
+        }
+
+        for (int n = 0; n < OVERLAY_SCALE; n++) {
+            if (overlay->picks[n] != -1) {
+                continue;
+            }
+            /* its sure cells and the ones no other number reaches, and the others' sure cells */
+            mask_t need = inters[n] | (open & unions[n] & ~twice);
+            mask_t avoid = sure & ~inters[n];
+            if ((need & ~inters[n]) == 0 && (avoid & unions[n]) == 0) {
+                continue;
+            }
+            level->counts[n] = overlay_filter(level->lists[n], level->counts[n], level->lists[n], need, avoid);
+            overlay->narrows++;
+            changed = 1;
+            if (level->counts[n] == 0) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* decide the numbers from depth on; returns 1 once all are decided */
+static int overlay_search(overlay_t *overlay, int depth, mask_t taken)
+{
+    if (!overlay_narrow(overlay, depth, taken)) {
+        return 0;
+    }
+    if (depth == OVERLAY_SCALE) {
+        return 1;
+    }
+
+    overlay_level_t *level = overlay->levels + depth, *next = level + 1;
+    int pick = -1;
+    for (int n = 0; n < OVERLAY_SCALE; n++) {
+        if (overlay->picks[n] == -1 && (pick == -1 || level->counts[n] < level->counts[pick])) {
+            pick = n;
+        }
+    }
+
+    unsigned short *room = overlay->pool + overlay->stride * (depth + 1);
+    for (int k = 0; k < level->counts[pick]; k++) {
+        mask_t cells = overlay_table[level->lists[pick][k]];
+        unsigned short *at = room;
+        int alive = 1;
+        overlay->nodes++;
+
+        /* the others keep the templates missing the cells taken */
+        for (int n = 0; n < OVERLAY_SCALE && alive; n++) {
+            if (overlay->picks[n] != -1 || n == pick) {
+                continue;
+            }
+            next->lists[n] = at;
+            next->counts[n] = overlay_filter(level->lists[n], level->counts[n], at, 0, cells);
+            at += next->counts[n];
+            alive = next->counts[n] > 0;
+        }
+        if (!alive) {
+            continue;
+        }
+        overlay->picks[pick] = level->lists[pick][k];
+        if (overlay_search(overlay, depth + 1, taken | cells)) {
+            return 1;
+        }
+        overlay->picks[pick] = -1;
+    }
+
+    return 0;
+}
+
+int overlay_run(overlay_t *overlay)
+{
+    for (int n = 0; n < OVERLAY_SCALE; n++) {
+        overlay->picks[n] = -1;
+    }
+    if (!overlay_search(overlay, 0, 0)) {
+        return 0;
+    }
+
+    for (int n = 0; n < OVERLAY_SCALE; n++) {
+        mask_t cells = overlay_table[overlay->picks[n]];
+        for (int i = 0; i < OVERLAY_SIZE; i++) {
+            if (cells >> i & 1) {
+                overlay->map[i] = n + 1;
+            }
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: MIT License
+/* portfolio.c -- racing search strategies on threads
+ * which heuristics suit a puzzle is hard to tell before solving it, and the time of one
+ * setting may differ from another by orders. so several searches with different settings
+ * run on the same puzzle at once, each on its own thread, and the first to find a solution
+ * or prove there is none wins. the members run as tasks stepped by a slice of guesses,
+ * and look at the race between steps, so the losers stop soon after.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <portfolio.h>
+#include <task.h>
+#include <search.h>
+#include <puzzle.h>
+#include <profile.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef struct portfolio_strategy {
+    int branch; /* branching policy */
+    int value; /* value order */
+    int propagation; /* propagation strength */
+    int restart; /* restart policy */
+    int backjump; /* 1 to backjump */
+}portfolio_strategy_t;
+
+/* the default search first, then the ones most unlike it */
+static const portfolio_strategy_t portfolio_table[] = {
+    {SEARCH_FEWEST, SEARCH_NATURAL, SEARCH_HIDDEN, SEARCH_NEVER, 1},
+    {SEARCH_WEIGHTED, SEARCH_LCV, SEARCH_HIDDEN, SEARCH_LUBY, 1},
+    {SEARCH_FEWEST, SEARCH_RANDOM, SEARCH_HIDDEN, SEARCH_LUBY, 1},
+    {SEARCH_WEIGHTED, SEARCH_RANDOM, SEARCH_HIDDEN, SEARCH_GEOMETRIC, 1},
+    {SEARCH_FEWEST, SEARCH_LCV, SEARCH_NAKED, SEARCH_NEVER, 1},
+    {SEARCH_FEWEST, SEARCH_NATURAL, SEARCH_HIDDEN, SEARCH_NEVER, 0},
+    {SEARCH_WEIGHTED, SEARCH_NATURAL, SEARCH_NAKED, SEARCH_LUBY, 1},
+    {SEARCH_FIRST, SEARCH_RANDOM, SEARCH_HIDDEN, SEARCH_LUBY, 1}
+};
+
+#define PORTFOLIO_TABLE (int)(sizeof(portfolio_table) / sizeof(portfolio_table[0]))
+
+portfolio_t *portfolio_create(puzzle_t *puzzle, int count, unsigned long long seed)
+{
+    portfolio_t *portfolio = malloc(sizeof(portfolio_t));
+    portfolio->count = count;
+    portfolio->members = malloc(sizeof(portfolio_member_t) * count);
+    portfolio->slice = PORTFOLIO_SLICE;
+    portfolio->done = 0;
+    portfolio->winner = -1;
+
+    for (int i = 0; i < count; i++) {
+        portfolio_member_t *member = portfolio->members + i;
+        member->task = task_create(puzzle);
+        if (member->task == NULL) {
+            portfolio->count = i;
+            portfolio_free(portfolio);
+            return NULL;
+        }
+        member->index = i;
+        member->cancelled = 0;
+        member->seconds = 0;
+        member->portfolio = portfolio;
+
+        const portfolio_strategy_t *strategy = portfolio_table + i % PORTFOLIO_TABLE;
+        search_t *search = member->task->search;
+        search->branch = strategy->branch;
+        /* another round of the table would repeat the same search unless shuffled */
+        search->value = i < PORTFOLIO_TABLE ? strategy->value : SEARCH_RANDOM;
+        search->propagation = strategy->propagation;
+        search->restart = strategy->restart;
+        search->backjump = strategy->backjump;
+        search_seed(search, seed + i);
+    }
+
+    return portfolio;
+}
+
+void portfolio_free(portfolio_t *portfolio)
+{
+    for (int i = 0; i < portfolio->count; i++) {
+        task_free(portfolio->members[i].task);
+    }
+    free(portfolio->members);
+    free(portfolio);
+}
+
+/* describe the settings of the search of a member */
+static void portfolio_name(portfolio_member_t *member)
+{
+    static const char *branches[] = {"first", "fewest", "weighted"};
+    static const char *values[] = {"natural", "lcv", "random"};
+    static const char *propagations[] = {"naked", "hidden", "matching"};
+    static const char *restarts[] = {"never", "luby", "geometric"};
+    search_t *search = member->task->search;
+
+    snprintf(member->name, sizeof(member->name), "%s/%s/%s/%s%s",
+        branches[search->branch], values[search->value], propagations[search->propagation],
+        restarts[search->restart], search->backjump ? "/backjump" : "");
+}
+
+/* step the task of a member until it finishes or another member has */
+static void *portfolio_worker(void *data)
+{
+    portfolio_member_t *member = data;
+    portfolio_t *portfolio = member->portfolio;
+    struct timespec start, stop;
+
+    profile_attach();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (task_step(member->task, portfolio->slice) == TASK_RUNNING) {
+        if (__atomic_load_n(&portfolio->done, __ATOMIC_ACQUIRE)) {
+            member->cancelled = 1;
+            break;
+        }
+    }
+    if (!member->cancelled) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&portfolio->done, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            portfolio->winner = member->index;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    member->seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    profile_detach();
+
+    return NULL;
+}
+
+int portfolio_run(portfolio_t *portfolio)
+{
+    pthread_t *threads = malloc(sizeof(pthread_t) * portfolio->count);
+
+    portfolio->done = 0;
+    portfolio->winner = -1;
+    for (int i = 0; i < portfolio->count; i++) {
+        portfolio_name(portfolio->members + i);
+        pthread_create(threads + i, NULL, portfolio_worker, portfolio->members + i);
+    }
+    for (int i = 0; i < portfolio->count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    if (portfolio->winner == -1) {
+        return TASK_UNSOLVABLE;
+    }
+    return portfolio->members[portfolio->winner].task->state;
+}
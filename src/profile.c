@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: MIT License
+/* profile.c -- the sampling profiler of solver stages
+ * stage counters tell how much work was done, not where the time went, nor how it moved
+ * while the search went deeper. so the solvers only store the stage and guess depth they
+ * are in to a word of their thread, and a timer on the cpu time of every thread raises
+ * SIGPROF hz times a cpu second of it. a timer on the cpu time of the process would signal
+ * the process, and the kernel picks any thread to run the handler, so the samples of the
+ * solver threads would be counted on a waiting thread. a timer of each thread is directed
+ * to it, and the handler counts a sample of the stage and depth in the word of the thread
+ * spending the time. the thread calling profile_start is sampled, and the worker threads
+ * of the solvers attach and detach themselves.
+ *
+ * the handler only adds to preallocated counters, so it is safe in a signal. the kernel
+ * fires the timer on its ticks, so the periods missed in between weigh on the sample. the
+ * counts by stage and depth make a folded stack report for flame graphs, and rows of a few
+ * samples each make a time series, two rows merged into one whenever the rows run out, so
+ * a run of any length fits. a mark costs a store, and a sample a few atomic adds.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <profile.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* the target thread of SIGEV_THREAD_ID, missing from older c libraries */
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+__thread volatile int profile_where = PROFILE_OTHER;
+
+static const char *profile_names[PROFILE_STAGES] = {
+    "other", "void", "number", "fill", "validate", "guess", "drawback", "propagate", "render"
+};
+
+/* samples of every stage at every depth */
+static long profile_counts[PROFILE_STAGES*(PROFILE_DEPTH+1)];
+/* samples of every stage and the sum of depths in every row of the time series */
+static long profile_rows[PROFILE_ROWS][PROFILE_STAGES+1];
+static long profile_width; /* samples a row takes */
+static long profile_taken; /* samples put in rows */
+static int profile_busy; /* a handler is putting a sample in rows */
+static long profile_total; /* samples since the start */
+static int profile_hz; /* samples a cpu second */
+static int profile_on; /* sampling between start and stop */
+static timer_t profile_timers[PROFILE_THREADS]; /* the timer of every thread attached */
+static int profile_used[PROFILE_THREADS];
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread int profile_slot = -1; /* the timer of the thread, -1 if not attached */
+static struct sigaction profile_old;
+
+static void profile_sample(int sig)
+{
+    (void)sig;
+    int where = profile_where;
+    int stage = where & 15, depth = where >> 4;
+    /* periods missed since the last tick */
+    int slot = profile_slot;
+    long weight = slot >= 0 ? 1 + timer_getoverrun(profile_timers[slot]) : 1;
+    if (weight < 1) {
+        weight = 1;
+    }
+
+    __atomic_fetch_add(profile_counts + PROFILE_STAGES * depth + stage, weight, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&profile_total, weight, __ATOMIC_RELAXED);
+
+    /* another thread in the rows loses its sample to the series only */
+    if (__atomic_exchange_n(&profile_busy, 1, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    while (profile_taken >= profile_width * PROFILE_ROWS) {
+        for (int r = 0; r < PROFILE_ROWS / 2; r++) {
+            for (int k = 0; k <= PROFILE_STAGES; k++) {
+                profile_rows[r][k] = profile_rows[2*r][k] + profile_rows[2*r+1][k];
+            }
+        }
+        memset(profile_rows + PROFILE_ROWS / 2, 0, sizeof(profile_rows) / 2);
+        profile_width *= 2;
+    }
+    long *row = profile_rows[profile_taken/profile_width];
+    row[stage] += weight;
+    row[PROFILE_STAGES] += depth * weight;
+    profile_taken += weight;
+    __atomic_store_n(&profile_busy, 0, __ATOMIC_RELEASE);
+}
+
+int profile_attach(void)
+{
+    struct sigevent event;
+    clockid_t clock;
+    int slot = -1;
+
+    if (profile_slot >= 0 || pthread_getcpuclockid(pthread_self(), &clock) != 0) {
+        return 0;
+    }
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = syscall(SYS_gettid);
+
+    pthread_mutex_lock(&profile_lock);
+    for (int i = 0; i < PROFILE_THREADS && profile_on; i++) {
+        if (!profile_used[i]) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot >= 0 && timer_create(clock, &event, profile_timers + slot) == 0) {
+        struct itimerspec every = {{0, 1000000000L / profile_hz}, {0, 1000000000L / profile_hz}};
+        if (profile_hz == 1) {
+            every = (struct itimerspec){{1, 0}, {1, 0}};
+        }
+        profile_used[slot] = 1;
+        profile_slot = slot;
+        timer_settime(profile_timers[slot], 0, &every, NULL);
+    }
+    pthread_mutex_unlock(&profile_lock);
+    return profile_slot >= 0;
+}
+
+void profile_detach(void)
+{
+    int slot = profile_slot;
+
+    if (slot < 0) {
+        return;
+    }
+    pthread_mutex_lock(&profile_lock);
+    /* stop may have deleted it already */
+    if (profile_used[slot]) {
+        timer_delete(profile_timers[slot]);
+        profile_used[slot] = 0;
+    }
+    profile_slot = -1;
+    pthread_mutex_unlock(&profile_lock);
+}
+
+int profile_start(int hz)
+{
+    if (hz < 1 || hz > 1000000) {
+        return 0;
+    }
+    memset(profile_counts, 0, sizeof(profile_counts));
+    memset(profile_rows, 0, sizeof(profile_rows));
+    profile_width = 1;
+    profile_taken = 0;
+    profile_busy = 0;
+    profile_total = 0;
+    profile_hz = hz;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = profile_sample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &profile_old) != 0) {
+        return 0;
+    }
+
+    profile_on = 1;
+    if (!profile_attach()) {
+        profile_on = 0;
+        sigaction(SIGPROF, &profile_old, NULL);
+        return 0;
+    }
+    return 1;
+}
+
+/* write the samples of every stage at every depth, one stack a line */
+static void profile_folded(FILE *pf)
+{
+    for (int depth = 0; depth <= PROFILE_DEPTH; depth++) {
+        for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+            long count = profile_counts[PROFILE_STAGES*depth+stage];
+            if (count > 0) {
+                fprintf(pf, "sudoku;depth_%d;%s %ld\n", depth, profile_names[stage], count);
+            }
+        }
+    }
+}
+
+/* write the rows of the time series, a row starting at the cpu seconds of its first sample */
+static void profile_series(FILE *pf)
+{
+    fprintf(pf, "# seconds samples");
+    for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+        fprintf(pf, " %s", profile_names[stage]);
+    }
+    fprintf(pf, " depth\n");
+    for (long r = 0; r * profile_width < profile_taken; r++) {
+        long samples = 0;
+        for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+            samples += profile_rows[r][stage];
+        }
+        fprintf(pf, "%.3f %ld", (double)r * profile_width / profile_hz, samples);
+        for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+            fprintf(pf, " %ld", profile_rows[r][stage]);
+        }
+        fprintf(pf, " %.1f\n", samples ? (double)profile_rows[r][PROFILE_STAGES] / samples : 0);
+    }
+}
+
+long profile_stop(char *path, int format)
+{
+    /* the threads still attached lose their timers, and detach later for nothing */
+    pthread_mutex_lock(&profile_lock);
+    profile_on = 0;
+    for (int i = 0; i < PROFILE_THREADS; i++) {
+        if (profile_used[i]) {
+            timer_delete(profile_timers[i]);
+            profile_used[i] = 0;
+        }
+    }
+    pthread_mutex_unlock(&profile_lock);
+    profile_slot = -1;
+    sigaction(SIGPROF, &profile_old, NULL);
+
+    FILE *pf = fopen(path, "w");
+    if (pf == NULL) {
+        return -1;
+    }
+    if (format == PROFILE_SERIES) {
+        profile_series(pf);
+    }
+    else {
+        profile_folded(pf);
+    }
+    fclose(pf);
+    return profile_total;
+}
+
+const char *profile_name(int stage)
+{
+    return profile_names[stage];
+}
+
+long profile_samples(int stage)
+{
+    long count = 0;
+    for (int depth = 0; depth <= PROFILE_DEPTH; depth++) {
+        count += profile_counts[PROFILE_STAGES*depth+stage];
+    }
+    return count;
+}
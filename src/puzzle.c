@@ -8,6 +8,7 @@
 
 #include <puzzle.h>
 #include <fileio.h>
+#include <render.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -32,7 +33,7 @@ puzzle_t *puzzle_make_default()
     puzzle->order = 3;
     puzzle->scale = 9;
     puzzle->size = 81;
-    puzzle->map = malloc(sizeof(int)*puzzle->size);
+    puzzle->map = malloc(sizeof(cell_t)*puzzle->size);
     for (int i = 0; i < puzzle->size; i++) {
         puzzle->map[i] = puzzle_map[i];
     }
@@ -52,7 +53,7 @@ puzzle_t *puzzle_make_swap(int order)
     int puzzle_size = pow(order, 4);
 
     /* initialize puzzle map */
-    int *puzzle_map = malloc(sizeof(int)*puzzle_size);
+    cell_t *puzzle_map = malloc(sizeof(cell_t)*puzzle_size);
     /* scan rows */
     for (int i = 0; i < puzzle_scale; i++) {
         /* scan cols */
@@ -72,7 +73,7 @@ puzzle_t *puzzle_make_swap(int order)
     srand(time(0));
     int an, am, found;
     int *used_rand = malloc(sizeof(int)*floor(puzzle_order/2)*2);
-    int *temp_arrow = malloc(sizeof(int)*puzzle_scale);
+    cell_t *temp_arrow = malloc(sizeof(cell_t)*puzzle_scale);
     /* scan row chunks */
     for (int r = 0; r < puzzle_order; r++) {
         /* reset recording */
@@ -206,11 +207,24 @@ puzzle_t *puzzle_read_data(char *path)
     int puzzle_scale = sqrt(size);
     int puzzle_size = size;
 
-    int *puzzle_map = malloc(sizeof(int)*puzzle_size);
-    if (!fileio_read_data(path, puzzle_map, sizeof(int), puzzle_size)) {
+    /* the file keeps 4 bytes a cell, narrowed to cells once read */
+    int *data = malloc(sizeof(int)*puzzle_size);
+    if (!fileio_read_data(path, data, sizeof(int), puzzle_size)) {
         printf("[error] failed to read %s\n", path);
+        free(data);
         return NULL;
     }
+    cell_t *puzzle_map = malloc(sizeof(cell_t)*puzzle_size);
+    for (int i = 0; i < puzzle_size; i++) {
+        if (data[i] < 0 || data[i] > puzzle_scale) {
+            printf("[error] %d out of scale in %s\n", data[i], path);
+            free(data);
+            free(puzzle_map);
+            return NULL;
+        }
+        puzzle_map[i] = data[i];
+    }
+    free(data);
 
     puzzle_t *puzzle = malloc(sizeof(puzzle_t));
     puzzle->order = puzzle_order;
@@ -224,7 +238,13 @@ puzzle_t *puzzle_read_data(char *path)
 
 void puzzle_write_data(char *path, puzzle_t *puzzle)
 {
-    if (fileio_write_data(path, puzzle->map, sizeof(int), puzzle->size)) {
+    int *data = malloc(sizeof(int)*puzzle->size);
+    for (int i = 0; i < puzzle->size; i++) {
+        data[i] = puzzle->map[i];
+    }
+    int written = fileio_write_data(path, data, sizeof(int), puzzle->size);
+    free(data);
+    if (written) {
         printf("[okey] write %s successfully\n", path);
     }
     else {
@@ -234,39 +254,9 @@ void puzzle_write_data(char *path, puzzle_t *puzzle)
 
 void puzzle_print_console(puzzle_t *puzzle)
 {
-    int num;
-    int puzzle_order = puzzle->order;
-    int puzzle_scale = puzzle->scale;
-    int *puzzle_map = puzzle->map;
-
-    /* draw border */
-    for (int c = 0; c < (3 * puzzle_scale + 1); c++) {
-        printf("-");
-    }
-    printf("\n");
-
-    /* scan rows */
-    for (int i = 0; i < puzzle_scale; i++) {
-        printf("|");
-        /* scan cols */
-        for (int j = 0; j < puzzle_scale; j++) {
-            num = puzzle_map[puzzle_scale*i+j];
-            /* draw border */
-            if (((j + 1) % puzzle_order) == 0) {
-                num != 0 ? printf("%2d", num) : printf("  ");
-                printf("|");
-            }
-            else {
-                num != 0 ? printf("%2d ", num) : printf("   ");
-            }
-        }
-        printf("\n");
-        /* draw border */
-        if (((i + 1) % puzzle_order) == 0) {
-            for (int c = 0; c < (3 * puzzle_scale + 1); c++) {
-                printf("-");
-            }
-            printf("\n");
-        }
-    }
+    /* format the whole grid first and write it at once */
+    char *text = malloc(render_length(puzzle->order));
+    int length = render_grid(text, puzzle->order, puzzle->map);
+    fwrite(text, 1, length, stdout);
+    free(text);
 }
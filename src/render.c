@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: MIT License
+/* render.c -- buffered console renderer
+ * every frame is formatted into one reusable buffer and written by a single call,
+ * instead of a printf for every cell and border.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <render.h>
+#include <profile.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* microseconds of the monotonic clock */
+static long render_now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000L + now.tv_nsec / 1000;
+}
+
+/* format a number right aligned in width like "%*d"; returns the length */
+static int render_number(char *text, int num, int width)
+{
+    char digits[12];
+    int count = 0;
+    int length = 0;
+
+    do {
+        digits[count++] = '0' + num % 10;
+        num /= 10;
+    } while (num > 0);
+    while (width-- > count) {
+        text[length++] = ' ';
+    }
+    while (count > 0) {
+        text[length++] = digits[--count];
+    }
+
+    return length;
+}
+
+/* format a border line; returns the length */
+static int render_border(char *text, int scale)
+{
+    memset(text, '-', 3 * scale + 1);
+    text[3 * scale + 1] = '\n';
+    return 3 * scale + 2;
+}
+
+int render_length(int order)
+{
+    int scale = order * order;
+    /* numbers take at most 3 digits and a separator */
+    return scale * (4 * scale + 2) + (order + 1) * (3 * scale + 2) + 1;
+}
+
+int render_grid(char *text, int order, cell_t *map)
+{
+    int scale = order * order;
+    int length = 0;
+    int num;
+
+    length += render_border(text + length, scale);
+    /* scan rows */
+    for (int i = 0; i < scale; i++) {
+        text[length++] = '|';
+        /* scan cols */
+        for (int j = 0; j < scale; j++) {
+            num = map[scale*i+j];
+            if (num != 0) {
+                length += render_number(text + length, num, 2);
+            }
+            else {
+                text[length++] = ' ';
+                text[length++] = ' ';
+            }
+            /* draw border */
+            text[length++] = ((j + 1) % order) == 0 ? '|' : ' ';
+        }
+        text[length++] = '\n';
+        /* draw border */
+        if (((i + 1) % order) == 0) {
+            length += render_border(text + length, scale);
+        }
+    }
+
+    return length;
+}
+
+render_t *render_create(puzzle_t *puzzle, int mode, long interval)
+{
+    render_t *render = malloc(sizeof(render_t));
+    render->order = puzzle->order;
+    render->scale = puzzle->scale;
+    render->size = puzzle->size;
+    render->mode = mode;
+    render->interval = interval;
+    /* a diff entry "num -> {row, col}, " takes at most 24 chars */
+    render->capacity = render_length(puzzle->order);
+    if (render->capacity < 24 * puzzle->size + 32) {
+        render->capacity = 24 * puzzle->size + 32;
+    }
+    render->buffer = malloc(render->capacity);
+    render->last = malloc(sizeof(cell_t) * puzzle->size);
+    render->drawn = 0;
+    render->pending = 0;
+    render->lasttime = 0;
+    render->frames = 0;
+    render->skipped = 0;
+
+    return render;
+}
+
+void render_free(render_t *render)
+{
+    free(render->buffer);
+    free(render->last);
+    free(render);
+}
+
+/* format the cells changed since the last frame; returns the length, 0 if none */
+static int render_diff(render_t *render, cell_t *map)
+{
+    char *text = render->buffer;
+    int scale = render->scale;
+    int length = 0;
+    int changed = 0;
+
+    memcpy(text, "[diff] ", 7);
+    length += 7;
+    for (int i = 0; i < render->size; i++) {
+        if (map[i] == render->last[i]) {
+            continue;
+        }
+        changed++;
+        length += render_number(text + length, map[i], 1);
+        memcpy(text + length, " -> {", 5);
+        length += 5;
+        length += render_number(text + length, i / scale, 1);
+        text[length++] = ',';
+        text[length++] = ' ';
+        length += render_number(text + length, i % scale, 1);
+        memcpy(text + length, "}, ", 3);
+        length += 3;
+    }
+    text[length++] = '\n';
+    text[length++] = '\n';
+
+    return changed ? length : 0;
+}
+
+int render_frame(render_t *render, cell_t *map)
+{
+    long now = 0;
+    int length;
+
+    profile_stage(PROFILE_RENDER);
+    if (render->interval > 0) {
+        now = render_now();
+        if (render->drawn && now - render->lasttime < render->interval) {
+            render->pending = 1;
+            render->skipped++;
+            return 0;
+        }
+    }
+
+    /* the first frame is always full */
+    if (render->mode == RENDER_DIFF && render->drawn) {
+        length = render_diff(render, map);
+    }
+    else {
+        length = render_grid(render->buffer, render->order, map);
+    }
+    if (length > 0) {
+        fwrite(render->buffer, 1, length, stdout);
+    }
+    memcpy(render->last, map, sizeof(cell_t) * render->size);
+    render->drawn = 1;
+    render->pending = 0;
+    render->lasttime = now;
+    render->frames++;
+
+    return 1;
+}
+
+void render_flush(render_t *render, cell_t *map)
+{
+    if (render->pending) {
+        long interval = render->interval;
+        render->interval = 0;
+        render_frame(render, map);
+        render->interval = interval;
+    }
+}
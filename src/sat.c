@@ -0,0 +1,608 @@
+// SPDX-License-Identifier: MIT License
+/* sat.c -- the embedded CDCL solver
+ * a small conflict driven clause learning solver without external dependency:
+ * two watched literals for propagation, vsids with a heap for decisions, phase saving,
+ * first uip learning with minimization, luby restarts and lbd based clause reduction.
+ * a literal is 2*var for positive and 2*var+1 for negative, var is 0-based inside.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <sat.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SAT_LEARNT 1
+#define SAT_DELETED 2
+
+#define SAT_HEAD 3 /* size, flags and lbd before literals */
+#define SAT_RESTART 100 /* conflicts of one luby unit */
+
+#define sat_var(lit) ((lit) >> 1)
+#define sat_neg(lit) ((lit) ^ 1)
+#define sat_lits(sat, cref) ((sat)->arena + (cref) + SAT_HEAD)
+
+/* value of a literal, 1 true, -1 false, 0 unassigned */
+static inline int sat_lit_value(sat_t *sat, int lit)
+{
+    int value = sat->assigns[sat_var(lit)];
+    return (lit & 1) ? -value : value;
+}
+
+/* heap of variables by activity */
+
+static void sat_heap_up(sat_t *sat, int i)
+{
+    int v = sat->heap[i];
+    while (i > 0) {
+        int parent = (i - 1) >> 1;
+        if (sat->activity[sat->heap[parent]] >= sat->activity[v]) {
+            break;
+        }
+        sat->heap[i] = sat->heap[parent];
+        sat->heapindex[sat->heap[i]] = i;
+        i = parent;
+    }
+    sat->heap[i] = v;
+    sat->heapindex[v] = i;
+}
+
+static void sat_heap_down(sat_t *sat, int i)
+{
+    int v = sat->heap[i];
+    while (2 * i + 1 < sat->heapsize) {
+        int child = 2 * i + 1;
+        if (child + 1 < sat->heapsize && sat->activity[sat->heap[child+1]] > sat->activity[sat->heap[child]]) {
+            child++;
+        }
+        if (sat->activity[sat->heap[child]] <= sat->activity[v]) {
+            break;
+        }
+        sat->heap[i] = sat->heap[child];
+        sat->heapindex[sat->heap[i]] = i;
+        i = child;
+    }
+    sat->heap[i] = v;
+    sat->heapindex[v] = i;
+}
+
+static void sat_heap_insert(sat_t *sat, int v)
+{
+    if (sat->heapindex[v] != -1) {
+        return;
+    }
+    sat->heap[sat->heapsize] = v;
+    sat->heapindex[v] = sat->heapsize;
+    sat_heap_up(sat, sat->heapsize++);
+}
+
+static int sat_heap_pop(sat_t *sat)
+{
+    int v = sat->heap[0];
+    sat->heapindex[v] = -1;
+    if (--sat->heapsize > 0) {
+        sat->heap[0] = sat->heap[sat->heapsize];
+        sat->heapindex[sat->heap[0]] = 0;
+        sat_heap_down(sat, 0);
+    }
+    return v;
+}
+
+static void sat_bump(sat_t *sat, int v)
+{
+    if ((sat->activity[v] += sat->varinc) > 1e100) {
+        /* rescale every activity */
+        for (int i = 0; i < sat->totalvar; i++) {
+            sat->activity[i] *= 1e-100;
+        }
+        sat->varinc *= 1e-100;
+    }
+    if (sat->heapindex[v] != -1) {
+        sat_heap_up(sat, sat->heapindex[v]);
+    }
+}
+
+/* clauses and watches */
+
+static void sat_watch(sat_t *sat, int lit, int cref, int blocker)
+{
+    sat_watches_t *ws = sat->watches + lit;
+    if (ws->count == ws->capacity) {
+        ws->capacity = ws->capacity ? 2 * ws->capacity : 4;
+        ws->list = realloc(ws->list, sizeof(sat_watch_t) * ws->capacity);
+    }
+    ws->list[ws->count].cref = cref;
+    ws->list[ws->count].blocker = blocker;
+    ws->count++;
+}
+
+static int sat_alloc(sat_t *sat, int *lits, int count, int learnt, int lbd)
+{
+    if (sat->arenasize + SAT_HEAD + count > sat->arenacap) {
+        while (sat->arenasize + SAT_HEAD + count > sat->arenacap) {
+            sat->arenacap *= 2;
+        }
+        sat->arena = realloc(sat->arena, sizeof(int) * sat->arenacap);
+    }
+    int cref = sat->arenasize;
+    sat->arena[cref] = count;
+    sat->arena[cref+1] = learnt ? SAT_LEARNT : 0;
+    sat->arena[cref+2] = lbd;
+    memcpy(sat->arena + cref + SAT_HEAD, lits, sizeof(int) * count);
+    sat->arenasize += SAT_HEAD + count;
+
+    /* lits[0] and lits[1] are watched, a clause is checked when a watched literal turns false */
+    sat_watch(sat, lits[0], cref, lits[1]);
+    sat_watch(sat, lits[1], cref, lits[0]);
+
+    return cref;
+}
+
+static void sat_assign(sat_t *sat, int lit, int reason)
+{
+    int v = sat_var(lit);
+    sat->assigns[v] = (lit & 1) ? -1 : 1;
+    sat->levels[v] = sat->level;
+    sat->reasons[v] = reason;
+    sat->trail[sat->trailsize++] = lit;
+}
+
+sat_t *sat_create(int totalvar)
+{
+    sat_t *sat = calloc(1, sizeof(sat_t));
+    sat->totalvar = totalvar;
+    sat->arenacap = 1024;
+    sat->arena = malloc(sizeof(int) * sat->arenacap);
+    sat->learntcap = 1024;
+    sat->learnts = malloc(sizeof(int) * sat->learntcap);
+    sat->watches = calloc(2 * totalvar + 2, sizeof(sat_watches_t));
+    sat->assigns = calloc(totalvar + 1, sizeof(signed char));
+    sat->phases = malloc(sizeof(signed char) * (totalvar + 1));
+    sat->levels = calloc(totalvar + 1, sizeof(int));
+    sat->reasons = malloc(sizeof(int) * (totalvar + 1));
+    sat->trail = malloc(sizeof(int) * (totalvar + 1));
+    sat->trailhead = malloc(sizeof(int) * (totalvar + 1));
+    sat->activity = calloc(totalvar + 1, sizeof(double));
+    sat->varinc = 1;
+    sat->heap = malloc(sizeof(int) * (totalvar + 1));
+    sat->heapindex = malloc(sizeof(int) * (totalvar + 1));
+    sat->seen = calloc(totalvar + 1, sizeof(char));
+    sat->learnt = malloc(sizeof(int) * 2 * (totalvar + 1));
+
+    for (int v = 0; v < totalvar; v++) {
+        /* most variables of a sudoku are false, so try false first */
+        sat->phases[v] = -1;
+        sat->reasons[v] = -1;
+        sat->heap[v] = v;
+        sat->heapindex[v] = v;
+    }
+    sat->heapsize = totalvar;
+
+    return sat;
+}
+
+void sat_free(sat_t *sat)
+{
+    for (int lit = 0; lit < 2 * sat->totalvar + 2; lit++) {
+        free(sat->watches[lit].list);
+    }
+    free(sat->watches);
+    free(sat->arena);
+    free(sat->learnts);
+    free(sat->assigns);
+    free(sat->phases);
+    free(sat->levels);
+    free(sat->reasons);
+    free(sat->trail);
+    free(sat->trailhead);
+    free(sat->activity);
+    free(sat->heap);
+    free(sat->heapindex);
+    free(sat->seen);
+    free(sat->learnt);
+    free(sat);
+}
+
+int sat_add_clause(sat_t *sat, int *lits, int count)
+{
+    if (sat->unsat) {
+        return 0;
+    }
+
+    /* convert to inner literals, drop the false ones and keep the clause if none is true */
+    int *clause = sat->learnt;
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+        int lit = lits[i] > 0 ? 2 * (lits[i] - 1) : 2 * (-lits[i] - 1) + 1;
+        int value = sat_lit_value(sat, lit);
+        if (value == 1) {
+            return 1;
+        }
+        if (value == 0) {
+            clause[size++] = lit;
+        }
+    }
+
+    if (size == 0) {
+        sat->unsat = 1;
+        return 0;
+    }
+    if (size == 1) {
+        sat_assign(sat, clause[0], -1);
+        return 1;
+    }
+    sat_alloc(sat, clause, size, 0, 0);
+    return 1;
+}
+
+/* propagate the trail; returns the conflicting clause or -1 */
+static int sat_propagate(sat_t *sat)
+{
+    int confl = -1;
+
+    while (sat->qhead < sat->trailsize) {
+        int falselit = sat_neg(sat->trail[sat->qhead++]);
+        sat_watches_t *ws = sat->watches + falselit;
+        sat_watch_t *list = ws->list;
+        int i = 0, j = 0, n = ws->count;
+        sat->propagations++;
+
+        while (i < n) {
+            sat_watch_t w = list[i++];
+            if (sat_lit_value(sat, w.blocker) == 1) {
+                list[j++] = w;
+                continue;
+            }
+            if (sat->arena[w.cref+1] & SAT_DELETED) {
+                continue;
+            }
+            int *c = sat_lits(sat, w.cref);
+            int size = sat->arena[w.cref];
+            if (c[0] == falselit) {
+                c[0] = c[1];
+                c[1] = falselit;
+            }
+            int first = c[0];
+            if (first != w.blocker && sat_lit_value(sat, first) == 1) {
+                list[j].cref = w.cref;
+                list[j++].blocker = first;
+                continue;
+            }
+            /* look for a new literal to watch */
+            int found = 0;
+            for (int k = 2; k < size; k++) {
+                if (sat_lit_value(sat, c[k]) != -1) {
+                    c[1] = c[k];
+                    c[k] = falselit;
+                    sat_watch(sat, c[1], w.cref, first);
+                    found = 1;
+                    break;
+                }
+            }
+            if (found) {
+                continue;
+            }
+            list[j++] = w;
+            if (sat_lit_value(sat, first) == -1) {
+                /* conflict, keep the rest of watches */
+                confl = w.cref;
+                while (i < n) {
+                    list[j++] = list[i++];
+                }
+                sat->qhead = sat->trailsize;
+            }
+            else {
+                sat_assign(sat, first, w.cref);
+            }
+        }
+        ws->count = j;
+        if (confl != -1) {
+            break;
+        }
+    }
+
+    return confl;
+}
+
+/* withdraw the assignments above level */
+static void sat_cancel(sat_t *sat, int level)
+{
+    if (sat->level <= level) {
+        return;
+    }
+    for (int i = sat->trailsize - 1; i >= sat->trailhead[level]; i--) {
+        int v = sat_var(sat->trail[i]);
+        sat->phases[v] = sat->assigns[v];
+        sat->assigns[v] = 0;
+        sat->reasons[v] = -1;
+        sat_heap_insert(sat, v);
+    }
+    sat->trailsize = sat->trailhead[level];
+    sat->qhead = sat->trailsize;
+    sat->level = level;
+}
+
+/* a literal of the learnt clause is redundant if its reason is covered by the clause */
+static int sat_redundant(sat_t *sat, int lit)
+{
+    int reason = sat->reasons[sat_var(lit)];
+    if (reason == -1) {
+        return 0;
+    }
+    int *c = sat_lits(sat, reason);
+    for (int k = 1; k < sat->arena[reason]; k++) {
+        int v = sat_var(c[k]);
+        if (!sat->seen[v] && sat->levels[v] > 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* first uip analysis; returns the size of learnt clause and sets the level to go back */
+static int sat_analyze(sat_t *sat, int confl, int *backlevel)
+{
+    int *learnt = sat->learnt;
+    int size = 1; /* learnt[0] is the asserting literal */
+    int pathcount = 0;
+    int lit = -1;
+    int index = sat->trailsize - 1;
+
+    do {
+        int *c = sat_lits(sat, confl);
+        for (int k = (lit == -1 ? 0 : 1); k < sat->arena[confl]; k++) {
+            int v = sat_var(c[k]);
+            if (!sat->seen[v] && sat->levels[v] > 0) {
+                sat_bump(sat, v);
+                sat->seen[v] = 1;
+                if (sat->levels[v] >= sat->level) {
+                    pathcount++;
+                }
+                else {
+                    learnt[size++] = c[k];
+                }
+            }
+        }
+        /* the next literal of the current level on trail */
+        while (!sat->seen[sat_var(sat->trail[index])]) {
+            index--;
+        }
+        lit = sat->trail[index--];
+        confl = sat->reasons[sat_var(lit)];
+        sat->seen[sat_var(lit)] = 0;
+        pathcount--;
+    } while (pathcount > 0);
+    learnt[0] = sat_neg(lit);
+
+    /* minimize, removed literals are kept after the clause to clear their marks */
+    int kept = 1, removed = size;
+    for (int i = 1; i < size; i++) {
+        if (sat_redundant(sat, learnt[i])) {
+            learnt[removed++] = learnt[i];
+        }
+        else {
+            learnt[kept++] = learnt[i];
+        }
+    }
+    for (int i = 1; i < kept; i++) {
+        sat->seen[sat_var(learnt[i])] = 0;
+    }
+    for (int i = size; i < removed; i++) {
+        sat->seen[sat_var(learnt[i])] = 0;
+    }
+    size = kept;
+
+    /* the second highest level goes to learnt[1] */
+    *backlevel = 0;
+    if (size > 1) {
+        int best = 1;
+        for (int i = 2; i < size; i++) {
+            if (sat->levels[sat_var(learnt[i])] > sat->levels[sat_var(learnt[best])]) {
+                best = i;
+            }
+        }
+        int temp = learnt[1];
+        learnt[1] = learnt[best];
+        learnt[best] = temp;
+        *backlevel = sat->levels[sat_var(learnt[1])];
+    }
+
+    return size;
+}
+
+/* count of distinct levels in the learnt clause */
+static int sat_lbd(sat_t *sat, int size)
+{
+    int lbd = 0;
+    for (int i = 0; i < size; i++) {
+        int level = sat->levels[sat_var(sat->learnt[i])];
+        int repeated = 0;
+        for (int k = 0; k < i; k++) {
+            if (sat->levels[sat_var(sat->learnt[k])] == level) {
+                repeated = 1;
+                break;
+            }
+        }
+        lbd += !repeated;
+    }
+    return lbd;
+}
+
+/* compact the arena, moving every live clause and fixing the refs */
+static void sat_collect(sat_t *sat)
+{
+    int *arena = malloc(sizeof(int) * sat->arenacap);
+    int size = 0;
+
+    for (int cref = 0; cref < sat->arenasize; cref += SAT_HEAD + sat->arena[cref]) {
+        int length = SAT_HEAD + sat->arena[cref];
+        if (!(sat->arena[cref+1] & SAT_DELETED)) {
+            memcpy(arena + size, sat->arena + cref, sizeof(int) * length);
+            /* leave the new ref in the old lbd */
+            sat->arena[cref+2] = size;
+            size += length;
+        }
+    }
+    for (int lit = 0; lit < 2 * sat->totalvar; lit++) {
+        sat_watches_t *ws = sat->watches + lit;
+        int j = 0;
+        for (int i = 0; i < ws->count; i++) {
+            int cref = ws->list[i].cref;
+            if (!(sat->arena[cref+1] & SAT_DELETED)) {
+                ws->list[j].cref = sat->arena[cref+2];
+                ws->list[j++].blocker = ws->list[i].blocker;
+            }
+        }
+        ws->count = j;
+    }
+    for (int i = 0; i < sat->trailsize; i++) {
+        int v = sat_var(sat->trail[i]);
+        if (sat->reasons[v] != -1) {
+            sat->reasons[v] = sat->arena[sat->reasons[v]+2];
+        }
+    }
+    for (int i = 0; i < sat->totallearnt; i++) {
+        sat->learnts[i] = sat->arena[sat->learnts[i]+2];
+    }
+
+    free(sat->arena);
+    sat->arena = arena;
+    sat->arenasize = size;
+    sat->wasted = 0;
+}
+
+typedef struct sat_rank {
+    int lbd; /* lbd of the clause */
+    int cref; /* the clause */
+}sat_rank_t;
+
+static int sat_cmp_rank(const void *a, const void *b)
+{
+    return ((sat_rank_t *)b)->lbd - ((sat_rank_t *)a)->lbd;
+}
+
+/* throw half of the learnt clauses with large lbd away */
+static void sat_reduce(sat_t *sat)
+{
+    sat_rank_t *ranks = malloc(sizeof(sat_rank_t) * sat->totallearnt);
+    for (int i = 0; i < sat->totallearnt; i++) {
+        ranks[i].lbd = sat->arena[sat->learnts[i]+2];
+        ranks[i].cref = sat->learnts[i];
+    }
+    qsort(ranks, sat->totallearnt, sizeof(sat_rank_t), sat_cmp_rank);
+    for (int i = 0; i < sat->totallearnt; i++) {
+        sat->learnts[i] = ranks[i].cref;
+    }
+    free(ranks);
+
+    int kept = 0;
+    for (int i = 0; i < sat->totallearnt; i++) {
+        int cref = sat->learnts[i];
+        int first = sat_lits(sat, cref)[0];
+        int locked = sat->reasons[sat_var(first)] == cref && sat_lit_value(sat, first) == 1;
+        if (i < sat->totallearnt / 2 && sat->arena[cref+2] > 2 && !locked) {
+            sat->arena[cref+1] |= SAT_DELETED;
+            sat->wasted += SAT_HEAD + sat->arena[cref];
+        }
+        else {
+            sat->learnts[kept++] = cref;
+        }
+    }
+    sat->totallearnt = kept;
+
+    if (sat->wasted > sat->arenasize / 2) {
+        sat_collect(sat);
+    }
+}
+
+/* the luby sequence 1, 1, 2, 1, 1, 2, 4, ... */
+static long sat_luby(long x)
+{
+    long size = 1, seq = 0;
+    while (size < x + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        seq--;
+        x = x % size;
+    }
+    return 1L << seq;
+}
+
+int sat_solve(sat_t *sat)
+{
+    if (sat->unsat || sat_propagate(sat) != -1) {
+        sat->unsat = 1;
+        return 0;
+    }
+    sat->maxlearnt = sat->arenasize / 12 + 4000;
+
+    long restartlimit = SAT_RESTART * sat_luby(0);
+    long restartconflicts = 0;
+    int backlevel;
+
+    while (1) {
+        int confl = sat_propagate(sat);
+        if (confl != -1) {
+            sat->conflicts++;
+            restartconflicts++;
+            if (sat->level == 0) {
+                sat->unsat = 1;
+                return 0;
+            }
+            int size = sat_analyze(sat, confl, &backlevel);
+            int lbd = sat_lbd(sat, size);
+            sat_cancel(sat, backlevel);
+            if (size == 1) {
+                sat_assign(sat, sat->learnt[0], -1);
+            }
+            else {
+                int cref = sat_alloc(sat, sat->learnt, size, 1, lbd);
+                if (sat->totallearnt == sat->learntcap) {
+                    sat->learntcap *= 2;
+                    sat->learnts = realloc(sat->learnts, sizeof(int) * sat->learntcap);
+                }
+                sat->learnts[sat->totallearnt++] = cref;
+                sat_assign(sat, sat->learnt[0], cref);
+            }
+            sat->varinc /= 0.95;
+            continue;
+        }
+
+        /* restart on the luby schedule */
+        if (restartconflicts >= restartlimit) {
+            sat->restarts++;
+            restartconflicts = 0;
+            restartlimit = SAT_RESTART * sat_luby(sat->restarts);
+            sat_cancel(sat, 0);
+        }
+        if (sat->totallearnt - sat->trailsize >= sat->maxlearnt) {
+            sat_reduce(sat);
+            sat->maxlearnt += sat->maxlearnt / 10;
+        }
+
+        /* decide the most active unassigned variable */
+        int v = -1;
+        while (sat->heapsize > 0) {
+            v = sat_heap_pop(sat);
+            if (sat->assigns[v] == 0) {
+                break;
+            }
+            v = -1;
+        }
+        if (v == -1) {
+            return 1;
+        }
+        sat->decisions++;
+        sat->trailhead[sat->level++] = sat->trailsize;
+        sat_assign(sat, sat->phases[v] == 1 ? 2 * v : 2 * v + 1, -1);
+    }
+}
+
+int sat_value(sat_t *sat, int v)
+{
+    return sat->assigns[v-1] == 1;
+}
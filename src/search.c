@@ -0,0 +1,1210 @@
+// SPDX-License-Identifier: MIT License
+/* search.c -- the quiet bitmask search engine
+ * keeps the numbers used by every row, col and chunk as masks, so the note of a void
+ * is computed in a few instructions and a fill is withdrawn by clearing three bits.
+ * nothing is printed, the engine is meant to be driven by other modules.
+ *
+ * every fill remembers the guess levels it depends on: a number is kept out of a void by
+ * the cell holding it in a row, col or chunk, or by a ban from a nogood. on contradiction
+ * the search jumps back to the deepest guess to blame instead of the last one, and small
+ * sets of blamed guesses are recorded as nogoods, checked whenever one of them is filled.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <search.h>
+#include <puzzle.h>
+#include <profile.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/* level sets */
+
+static inline void level_clear(level_t *set, int words)
+{
+    for (int w = 0; w < words; w++) {
+        set[w] = 0;
+    }
+}
+
+static inline void level_union(level_t *set, level_t *other, int words)
+{
+    for (int w = 0; w < words; w++) {
+        set[w] |= other[w];
+    }
+}
+
+/* every level below limit */
+static inline void level_fill(level_t *set, int limit)
+{
+    for (int w = 0; w <= (limit - 1) / 64; w++) {
+        set[w] = 64 * w + 64 <= limit ? ~(level_t)0 : ((level_t)1 << (limit - 64 * w)) - 1;
+    }
+}
+
+/* the deepest level below limit, -1 if none */
+static inline int level_top(level_t *set, int limit)
+{
+    for (int w = (limit - 1) / 64; w >= 0; w--) {
+        level_t bits = set[w];
+        if (64 * w + 64 > limit) {
+            bits &= ((level_t)1 << (limit - 64 * w)) - 1;
+        }
+        if (bits) {
+            return 64 * w + 63 - __builtin_clzll(bits);
+        }
+    }
+    return -1;
+}
+
+/* words holding the levels below the current guess depth */
+static inline int search_words(search_t *search)
+{
+    return search->guessed / 64 + 1;
+}
+
+/* fill a number in a void and record it */
+static void search_place(search_t *search, int cell, int num)
+{
+    int *unit = search->unitof + 3 * cell;
+    mask_t bit = mask_of(num);
+
+    search->map[cell] = num;
+    for (int k = 0; k < 3; k++) {
+        search->units[unit[k]] |= bit;
+        search->where[search->scale*unit[k]+num-1] = cell;
+    }
+    search->fills[search->totalfill++] = cell;
+}
+
+/* rebuild the mask of a unit from the map */
+static void search_rebuild(search_t *search, int u)
+{
+    int *member = search->members + search->scale * u;
+    mask_t used = 0;
+
+    for (int n = 1; n <= search->scale; n++) {
+        search->where[search->scale*u+n-1] = -1;
+    }
+    for (int k = 0; k < search->scale; k++) {
+        int num = search->map[member[k]];
+        if (num != 0) {
+            used |= mask_of(num);
+            search->where[search->scale*u+num-1] = member[k];
+        }
+    }
+    search->units[u] = used;
+}
+
+/* add the levels keeping num out of a void to set */
+static void search_explain(search_t *search, int cell, int num, level_t *set, int words)
+{
+    int *unit = search->unitof + 3 * cell;
+    int holder = -1, holdwords = words + 1;
+
+    /* the holder with the fewest levels, a given is the best */
+    for (int k = 0; k < 3; k++) {
+        int other = search->where[search->scale*unit[k]+num-1];
+        if (other != -1 && search->depwords[other] < holdwords) {
+            holder = other;
+            holdwords = search->depwords[other];
+        }
+    }
+    if (holder != -1) {
+        level_union(set, search->deps + search->words * holder, holdwords < words ? holdwords : words);
+        return;
+    }
+    /* banned by a nogood */
+    for (int b = search->totalban - 1; b >= 0; b--) {
+        if (search->banlog[b].cell == cell && search->banlog[b].num == num) {
+            level_union(set, search->bandeps + search->words * b, words);
+            return;
+        }
+    }
+}
+
+/* levels of a cell filled as the only candidate of its note */
+static void search_explain_naked(search_t *search, int cell, int num, level_t *set, int words)
+{
+    level_clear(set, words);
+    for (int n = 1; n <= search->scale; n++) {
+        if (n != num) {
+            search_explain(search, cell, n, set, words);
+        }
+    }
+}
+
+/* levels of a cell filled as the only place of num in unit u */
+static void search_explain_hidden(search_t *search, int cell, int num, int u, level_t *set, int words)
+{
+    int *member = search->members + search->scale * u;
+
+    level_clear(set, words);
+    for (int k = 0; k < search->scale; k++) {
+        int other = member[k];
+        if (other == cell) {
+            continue;
+        }
+        if (search->map[other] != 0) {
+            int used = search->depwords[other] < words ? search->depwords[other] : words;
+            level_union(set, search->deps + search->words * other, used);
+        }
+        else {
+            search_explain(search, other, num, set, words);
+        }
+    }
+}
+
+/* fill a number with the levels it depends on computed in conflict */
+static void search_place_with(search_t *search, int cell, int num, int words)
+{
+    if (search->backjump) {
+        memcpy(search->deps + search->words * cell, search->conflict, sizeof(level_t) * words);
+        search->depwords[cell] = words;
+    }
+    search_place(search, cell, num);
+}
+
+/* fill a guessed number, it depends on its own level only */
+static void search_place_guess(search_t *search, int cell, int num)
+{
+    int level = search->guessed - 1;
+    if (search->backjump) {
+        level_t *deps = search->deps + search->words * cell;
+        level_clear(deps, level / 64 + 1);
+        deps[level/64] = (level_t)1 << (level % 64);
+        search->depwords[cell] = level / 64 + 1;
+    }
+    search->phases[cell] = num;
+    search_place(search, cell, num);
+}
+
+/* forget every nogood */
+static void search_forget(search_t *search)
+{
+    search->totalnogood = 0;
+    for (int i = 0; i < search->size * search->scale; i++) {
+        search->nogoodof[i] = -1;
+    }
+}
+
+/* record the guesses in set as a nogood if it is small */
+static void search_record(search_t *search, level_t *set, int limit)
+{
+    int levels[SEARCH_NOGOOD];
+    int count = 0;
+
+    if (search->totalnogood == SEARCH_NOGOODS) {
+        return;
+    }
+    for (int g = 0; g < limit; g++) {
+        if (set[g/64] & ((level_t)1 << (g % 64))) {
+            if (count == SEARCH_NOGOOD) {
+                return;
+            }
+            levels[count++] = g;
+        }
+    }
+    if (count < 2) {
+        return;
+    }
+
+    search_nogood_t *nogood = search->nogoods + search->totalnogood;
+    nogood->count = count;
+    for (int k = 0; k < count; k++) {
+        search_guess_t *guess = search->guesses + levels[k];
+        int index = search->scale * guess->cell + guess->nums[guess->choice] - 1;
+        nogood->cells[k] = guess->cell;
+        nogood->nums[k] = guess->nums[guess->choice];
+        nogood->next[k] = search->nogoodof[index];
+        search->nogoodof[index] = SEARCH_NOGOOD * search->totalnogood + k;
+    }
+    search->totalnogood++;
+}
+
+/* ban num from a void, the ban depends on the levels in set */
+static void search_ban(search_t *search, int cell, int num, level_t *set, int words)
+{
+    if (search->totalban == search->bancap) {
+        search->bancap *= 2;
+        search->banlog = realloc(search->banlog, sizeof(search_ban_t) * search->bancap);
+        search->bandeps = realloc(search->bandeps, sizeof(level_t) * search->bancap * search->words);
+    }
+    search_ban_t *ban = search->banlog + search->totalban;
+    ban->cell = cell;
+    ban->num = num;
+    ban->stamp = search->totalfill;
+    memcpy(search->bandeps + search->words * search->totalban, set, sizeof(level_t) * words);
+    level_clear(search->bandeps + search->words * search->totalban + words, search->words - words);
+    search->totalban++;
+    search->bans[cell] |= mask_of(num);
+}
+
+/* check the nogoods holding a filled cell; returns -1 on contradiction, 1 if banned, or 0 */
+static int search_check(search_t *search, int cell)
+{
+    int words = search_words(search);
+    int slot = search->nogoodof[search->scale*cell+search->map[cell]-1];
+    int banned = 0;
+
+    while (slot != -1) {
+        search_nogood_t *nogood = search->nogoods + slot / SEARCH_NOGOOD;
+        int open = -1, fulfilled = 0, satisfied = 0;
+        slot = nogood->next[slot%SEARCH_NOGOOD];
+
+        for (int k = 0; k < nogood->count; k++) {
+            int num = search->map[nogood->cells[k]];
+            if (num == nogood->nums[k]) {
+                fulfilled++;
+            }
+            else if (num != 0 || open != -1) {
+                satisfied = 1;
+                break;
+            }
+            else {
+                open = k;
+            }
+        }
+        if (satisfied) {
+            continue;
+        }
+
+        /* the levels of the fulfilled decisions */
+        level_t *set = search->conflict;
+        level_clear(set, words);
+        for (int k = 0; k < nogood->count; k++) {
+            int other = nogood->cells[k];
+            if (k != open) {
+                int used = search->depwords[other] < words ? search->depwords[other] : words;
+                level_union(set, search->deps + search->words * other, used);
+            }
+        }
+        if (open == -1) {
+            return -1;
+        }
+
+        /* every decision but one is fulfilled, ban the last one */
+        int opencell = nogood->cells[open];
+        mask_t bit = mask_of(nogood->nums[open]);
+        if (search_note(search, opencell) & bit) {
+            search_ban(search, opencell, nogood->nums[open], set, words);
+            banned = 1;
+        }
+    }
+
+    return banned;
+}
+
+/* a contradiction was found, its blamed guesses make a nogood */
+static int search_contradict(search_t *search)
+{
+    if (search->backjump) {
+        search_record(search, search->conflict, search->guessed);
+    }
+    return 0;
+}
+
+search_t *search_create(puzzle_t *puzzle)
+{
+    int puzzle_order = puzzle->order;
+    int puzzle_scale = puzzle->scale;
+    int puzzle_size = puzzle->size;
+
+    if (puzzle_scale > 128) {
+        return NULL;
+    }
+
+    search_t *search = malloc(sizeof(search_t));
+    search->order = puzzle_order;
+    search->scale = puzzle_scale;
+    search->size = puzzle_size;
+    search->full = puzzle_scale == 128 ? ~(mask_t)0 : ((mask_t)1 << puzzle_scale) - 1;
+    search->map = calloc(puzzle_size, sizeof(cell_t));
+    search->units = calloc(3 * puzzle_scale, sizeof(mask_t));
+    search->unitof = malloc(sizeof(int) * 3 * puzzle_size);
+    search->members = malloc(sizeof(int) * 3 * puzzle_scale * puzzle_scale);
+    search->where = malloc(sizeof(int) * 3 * puzzle_scale * puzzle_scale);
+    for (int i = 0; i < 3 * puzzle_scale * puzzle_scale; i++) {
+        search->where[i] = -1;
+    }
+
+    /* rows come first, then cols, then chunks */
+    int *filled = calloc(3 * puzzle_scale, sizeof(int));
+    for (int i = 0; i < puzzle_scale; i++) {
+        for (int j = 0; j < puzzle_scale; j++) {
+            int cell = puzzle_scale * i + j;
+            int unit[3] = {
+                i,
+                puzzle_scale + j,
+                2 * puzzle_scale + (i / puzzle_order) * puzzle_order + j / puzzle_order
+            };
+            for (int k = 0; k < 3; k++) {
+                search->unitof[3*cell+k] = unit[k];
+                search->members[puzzle_scale*unit[k]+filled[unit[k]]++] = cell;
+            }
+        }
+    }
+    free(filled);
+
+    search->totalvoid = puzzle_size;
+    search->totalfill = 0;
+    search->guessed = 0;
+    search->clashes = 0;
+    search->stopped = 0;
+    search->nodes = 0;
+    search->drawbacks = 0;
+
+    /* create fill history and guess stack, a cell can be void at most once */
+    search->fills = malloc(sizeof(int) * puzzle_size);
+    search->guesses = malloc(sizeof(search_guess_t) * puzzle_size);
+    int *nums = malloc(sizeof(int) * puzzle_size * puzzle_scale);
+    for (int i = 0; i < puzzle_size; i++) {
+        search->guesses[i].nums = nums + puzzle_scale * i;
+    }
+
+    /* level sets are as wide as the deepest guess stack */
+    search->backjump = 1;
+    search->words = puzzle_size / 64 + 1;
+    search->deps = calloc(puzzle_size * search->words, sizeof(level_t));
+    search->depwords = calloc(puzzle_size, sizeof(int));
+    search->confs = calloc(puzzle_size * search->words, sizeof(level_t));
+    search->tainted = calloc(puzzle_size, sizeof(char));
+    search->conflict = calloc(search->words, sizeof(level_t));
+    search->jumps = 0;
+    search->bans = calloc(puzzle_size, sizeof(mask_t));
+    search->bancap = puzzle_size;
+    search->banlog = malloc(sizeof(search_ban_t) * search->bancap);
+    search->bandeps = malloc(sizeof(level_t) * search->bancap * search->words);
+    search->totalban = 0;
+    search->nogoods = malloc(sizeof(search_nogood_t) * SEARCH_NOGOODS);
+    search->nogoodof = malloc(sizeof(int) * puzzle_size * puzzle_scale);
+    search->checked = 0;
+    search->matchbans = 0;
+    search_forget(search);
+
+    search->branch = SEARCH_FEWEST;
+    search->value = SEARCH_NATURAL;
+    search->propagation = SEARCH_HIDDEN;
+    search_seed(search, 0);
+    search->restart = SEARCH_NEVER;
+    search->restartbase = 100;
+    search->restartgrowth = 1.5;
+    search->restarts = 0;
+    search->restartnodes = 0;
+    search->found = 0;
+    search->assumed = 0;
+    search->failures = calloc(puzzle_size, sizeof(long));
+    search->phases = calloc(puzzle_size, sizeof(int));
+    search->pause = 0;
+
+    /* put the givens, numbers out of scale are taken as voids */
+    for (int i = 0; i < puzzle_size; i++) {
+        if (puzzle->map[i] > 0 && puzzle->map[i] <= puzzle_scale) {
+            search_give(search, i, puzzle->map[i]);
+        }
+    }
+
+    return search;
+}
+
+void search_free(search_t *search)
+{
+    free(search->map);
+    free(search->units);
+    free(search->unitof);
+    free(search->members);
+    free(search->where);
+    free(search->fills);
+    free(search->guesses[0].nums);
+    free(search->guesses);
+    free(search->deps);
+    free(search->depwords);
+    free(search->confs);
+    free(search->tainted);
+    free(search->conflict);
+    free(search->bans);
+    free(search->banlog);
+    free(search->bandeps);
+    free(search->nogoods);
+    free(search->nogoodof);
+    free(search->failures);
+    free(search->phases);
+    free(search);
+}
+
+int search_give(search_t *search, int cell, int num)
+{
+    int *unit = search->unitof + 3 * cell;
+    mask_t bit = mask_of(num);
+    int clash = 0;
+
+    for (int k = 0; k < 3; k++) {
+        if (search->units[unit[k]] & bit) {
+            clash++;
+        }
+        search->units[unit[k]] |= bit;
+        search->where[search->scale*unit[k]+num-1] = cell;
+    }
+    search->map[cell] = num;
+    search->depwords[cell] = 0;
+    search->totalvoid--;
+    search->clashes += clash;
+
+    return clash == 0;
+}
+
+void search_take(search_t *search, int cell)
+{
+    int *unit = search->unitof + 3 * cell;
+    mask_t bit = mask_of(search->map[cell]);
+
+    search->map[cell] = 0;
+    search->totalvoid++;
+    for (int k = 0; k < 3; k++) {
+        search_rebuild(search, unit[k]);
+        /* the number is still there, so it was a duplication */
+        if (search->units[unit[k]] & bit) {
+            search->clashes--;
+        }
+    }
+    /* nogoods may rely on the given, and so may bans, the ones at the root outliving any undo */
+    search_forget(search);
+    search->totalban = 0;
+    memset(search->bans, 0, sizeof(mask_t) * search->size);
+}
+
+void search_undo(search_t *search, int back)
+{
+    int cell, num;
+    int *unit;
+    mask_t bit;
+
+    for (int i = search->totalfill - 1; i >= back; i--) {
+        cell = search->fills[i];
+        unit = search->unitof + 3 * cell;
+        num = search->map[cell];
+        bit = mask_of(num);
+        for (int k = 0; k < 3; k++) {
+            search->units[unit[k]] &= ~bit;
+            search->where[search->scale*unit[k]+num-1] = -1;
+        }
+        search->map[cell] = 0;
+    }
+    search->totalfill = back;
+
+    /* bans made after the back point */
+    while (search->totalban > 0 && search->banlog[search->totalban-1].stamp > back) {
+        search->totalban--;
+        search->bans[search->banlog[search->totalban].cell] &= ~mask_of(search->banlog[search->totalban].num);
+    }
+    if (search->checked > back) {
+        search->checked = back;
+    }
+}
+
+void search_reset(search_t *search)
+{
+    search_undo(search, 0);
+    search->guessed = 0;
+    search->stopped = 0;
+    search->found = 0;
+    search->assumed = 0;
+    search->restartnodes = search->nodes;
+}
+
+/* levels keeping the numbers of unit u out of its voids, and holding its filled cells */
+static void search_explain_unit(search_t *search, int u, level_t *set, int words)
+{
+    int *member = search->members + search->scale * u;
+
+    level_clear(set, words);
+    for (int k = 0; k < search->scale; k++) {
+        int cell = member[k];
+        if (search->map[cell] != 0) {
+            int used = search->depwords[cell] < words ? search->depwords[cell] : words;
+            level_union(set, search->deps + search->words * cell, used);
+            continue;
+        }
+        mask_t out = search->full & ~search->units[u] & ~search_note(search, cell);
+        while (out) {
+            search_explain(search, cell, mask_first(out), set, words);
+            out &= out - 1;
+        }
+    }
+}
+
+/* match void i to a number of its note, moving other voids along an augmenting path
+ * returns 0 if no path is left
+ */
+static int search_augment(mask_t *notes, int *match, int *owner, int i, mask_t *visited)
+{
+    mask_t open = notes[i] & ~*visited;
+
+    while (open) {
+        int num = mask_first(open);
+        open &= open - 1;
+        *visited |= mask_of(num);
+        if (owner[num-1] == -1 || search_augment(notes, match, owner, owner[num-1], visited)) {
+            match[i] = num;
+            owner[num-1] = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* the voids reachable from void s along edges within, as a mask of void indexes */
+static mask_t search_reach(mask_t *edges, int s, mask_t within)
+{
+    mask_t seen = mask_of(s + 1), frontier = seen;
+
+    while (frontier) {
+        mask_t next = 0;
+        while (frontier) {
+            next |= edges[mask_first(frontier)-1];
+            frontier &= frontier - 1;
+        }
+        frontier = next & within & ~seen;
+        seen |= frontier;
+    }
+    return seen;
+}
+
+/* all-different over the voids of unit u
+ * the voids are matched to the numbers left, and void i may take the number matched to
+ * void j only if i reaches j and back again, moving numbers along the matched ones, so
+ * a number is banned from a void in another strongly connected component than its owner
+ * returns -1 on contradiction, 1 if anything is banned, or 0
+ */
+static int search_match(search_t *search, int u, int words)
+{
+    int scale = search->scale;
+    int *member = search->members + scale * u;
+    int cells[128], match[128], owner[128], component[128];
+    mask_t notes[128], edges[128], backs[128];
+    int count = 0, banned = 0;
+
+    for (int k = 0; k < scale; k++) {
+        if (search->map[member[k]] == 0) {
+            cells[count] = member[k];
+            notes[count] = search_note(search, member[k]);
+            count++;
+        }
+        owner[k] = -1;
+    }
+    if (count < 2) {
+        return 0;
+    }
+
+    /* a maximum matching, by a greedy start and augmenting paths */
+    mask_t taken = 0;
+    for (int i = 0; i < count; i++) {
+        match[i] = 0;
+        if (notes[i] & ~taken) {
+            match[i] = mask_first(notes[i] & ~taken);
+            owner[match[i]-1] = i;
+            taken |= mask_of(match[i]);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        mask_t visited = 0;
+        if (match[i] == 0 && !search_augment(notes, match, owner, i, &visited)) {
+            /* fewer numbers than voids among some of them */
+            for (int k = 0; k < count; k++) {
+                search->failures[cells[k]]++;
+            }
+            if (search->backjump) {
+                search_explain_unit(search, u, search->conflict, words);
+            }
+            return -1;
+        }
+    }
+
+    /* void i goes to void j if it may take the number of j */
+    for (int i = 0; i < count; i++) {
+        edges[i] = 0;
+        backs[i] = 0;
+    }
+    for (int i = 0; i < count; i++) {
+        mask_t others = notes[i] & ~mask_of(match[i]);
+        while (others) {
+            int j = owner[mask_first(others)-1];
+            others &= others - 1;
+            edges[i] |= mask_of(j + 1);
+            backs[j] |= mask_of(i + 1);
+        }
+    }
+
+    /* peel the components off one by one */
+    mask_t left = search->full >> (scale - count);
+    for (int c = 0; left; c++) {
+        int s = mask_first(left) - 1;
+        mask_t part = search_reach(edges, s, left) & search_reach(backs, s, left);
+        left &= ~part;
+        while (part) {
+            component[mask_first(part)-1] = c;
+            part &= part - 1;
+        }
+    }
+    int explained = 0;
+    for (int i = 0; i < count; i++) {
+        mask_t others = notes[i] & ~mask_of(match[i]);
+        while (others) {
+            int num = mask_first(others);
+            others &= others - 1;
+            if (component[owner[num-1]] != component[i]) {
+                if (search->backjump && !explained) {
+                    search_explain_unit(search, u, search->conflict, words);
+                    explained = 1;
+                }
+                search_ban(search, cells[i], num, search->conflict, words);
+                search->matchbans++;
+                banned = 1;
+            }
+        }
+    }
+    return banned;
+}
+
+int search_propagate(search_t *search)
+{
+    /* situations:
+     * 1. a void with only one candidate, naked single
+     * 2. a number with only one place in a row, col or chunk, hidden single
+     * 3. every decision of a nogood but one is fulfilled, ban the last one
+     * 4. a number no matching of a unit can give to a void, ban it
+     * 5. a void without candidate, a number without place, a unit without matching or a fulfilled nogood, contradiction
+     */
+
+    int puzzle_scale = search->scale;
+    cell_t *puzzle_map = search->map;
+    int backjump = search->backjump;
+    profile_mark(PROFILE_PROPAGATE, search->guessed);
+    int words = search_words(search);
+
+    int changed = 1;
+    int *member;
+    mask_t note, once, twice, single, missing;
+
+    while (changed && search->totalfill < search->totalvoid) {
+        changed = 0;
+        /* nogoods holding the new fills */
+        while (backjump && search->checked < search->totalfill) {
+            int state = search_check(search, search->fills[search->checked++]);
+            if (state == -1) {
+                return search_contradict(search);
+            }
+            changed |= state;
+        }
+        /* naked singles */
+        for (int cell = 0; cell < search->size; cell++) {
+            if (puzzle_map[cell] != 0) {
+                continue;
+            }
+            note = search_note(search, cell);
+            if (note == 0) {
+                search->failures[cell]++;
+                if (backjump) {
+                    search_explain_naked(search, cell, 0, search->conflict, words);
+                }
+                return search_contradict(search);
+            }
+            if ((note & (note - 1)) == 0) {
+                if (backjump) {
+                    search_explain_naked(search, cell, mask_first(note), search->conflict, words);
+                }
+                search_place_with(search, cell, mask_first(note), words);
+                changed = 1;
+            }
+        }
+        /* hidden singles, unless naked ones are all the strength */
+        if (search->propagation >= SEARCH_HIDDEN) {
+            for (int u = 0; u < 3 * puzzle_scale; u++) {
+                member = search->members + puzzle_scale * u;
+                once = 0;
+                twice = 0;
+                for (int k = 0; k < puzzle_scale; k++) {
+                    if (puzzle_map[member[k]] == 0) {
+                        note = search_note(search, member[k]);
+                        twice |= once & note;
+                        once |= note;
+                    }
+                }
+                missing = search->full & ~(once | search->units[u]);
+                if (missing != 0) {
+                    for (int k = 0; k < puzzle_scale; k++) {
+                        if (puzzle_map[member[k]] == 0) {
+                            search->failures[member[k]]++;
+                        }
+                    }
+                    if (backjump) {
+                        search_explain_hidden(search, -1, mask_first(missing), u, search->conflict, words);
+                    }
+                    return search_contradict(search);
+                }
+                single = once & ~twice;
+                while (single) {
+                    int num = mask_first(single);
+                    single &= single - 1;
+                    for (int k = 0; k < puzzle_scale; k++) {
+                        if (puzzle_map[member[k]] == 0 && (search_note(search, member[k]) & mask_of(num))) {
+                            if (backjump) {
+                                search_explain_hidden(search, member[k], num, u, search->conflict, words);
+                            }
+                            search_place_with(search, member[k], num, words);
+                            changed = 1;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        /* all-different matching, only when the singles are exhausted as it costs more */
+        if (!changed && search->propagation == SEARCH_MATCHING && search->totalfill < search->totalvoid) {
+            for (int u = 0; u < 3 * puzzle_scale; u++) {
+                int state = search_match(search, u, words);
+                if (state == -1) {
+                    return search_contradict(search);
+                }
+                changed |= state;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* push a guess on the stack, its blame starts empty */
+static search_guess_t *search_push(search_t *search)
+{
+    int level = search->guessed++;
+    search_guess_t *guess = search->guesses + level;
+
+    guess->back = search->totalfill;
+    guess->choice = 0;
+    guess->count = 0;
+    if (search->backjump) {
+        level_clear(search->confs + search->words * level, level / 64 + 1);
+        search->tainted[level] = 0;
+    }
+
+    return guess;
+}
+
+void search_seed(search_t *search, unsigned long long seed)
+{
+    search->seed = seed ^ 0x9e3779b97f4a7c15ULL;
+    if (search->seed == 0) {
+        search->seed = 1;
+    }
+}
+
+void search_configure(search_t *search, search_t *settings)
+{
+    search->backjump = settings->backjump;
+    search->branch = settings->branch;
+    search->value = settings->value;
+    search->propagation = settings->propagation;
+    search->seed = settings->seed;
+    search->restart = settings->restart;
+    search->restartbase = settings->restartbase;
+    search->restartgrowth = settings->restartgrowth;
+}
+
+/* xorshift64* generator */
+static unsigned long long search_random(search_t *search)
+{
+    search->seed ^= search->seed >> 12;
+    search->seed ^= search->seed << 25;
+    search->seed ^= search->seed >> 27;
+    return search->seed * 0x2545f4914f6cdd1dULL;
+}
+
+/* count the voids around a cell which would lose num */
+static int search_constrain(search_t *search, int cell, int num)
+{
+    int *unit = search->unitof + 3 * cell;
+    mask_t bit = mask_of(num);
+    int count = 0;
+
+    for (int k = 0; k < 3; k++) {
+        int *member = search->members + search->scale * unit[k];
+        for (int m = 0; m < search->scale; m++) {
+            if (member[m] != cell && search->map[member[m]] == 0 && (search_note(search, member[m]) & bit)) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* sort the numbers of a guess in the value order */
+static void search_order(search_t *search, search_guess_t *guess)
+{
+    int *nums = guess->nums;
+    int count = guess->count;
+
+    if (search->value == SEARCH_LCV) {
+        int scores[128];
+        for (int c = 0; c < count; c++) {
+            scores[c] = search_constrain(search, guess->cell, nums[c]);
+        }
+        /* insertion sort keeps ascending numbers on ties */
+        for (int c = 1; c < count; c++) {
+            int num = nums[c], score = scores[c], d = c - 1;
+            while (d >= 0 && scores[d] > score) {
+                nums[d+1] = nums[d];
+                scores[d+1] = scores[d];
+                d--;
+            }
+            nums[d+1] = num;
+            scores[d+1] = score;
+        }
+    }
+    else if (search->value == SEARCH_RANDOM) {
+        for (int c = count - 1; c > 0; c--) {
+            int d = search_random(search) % (c + 1);
+            int temp = nums[c];
+            nums[c] = nums[d];
+            nums[d] = temp;
+        }
+    }
+
+    /* after restarts, the number guessed last time goes first */
+    if (search->restart != SEARCH_NEVER && search->restarts > 0) {
+        for (int c = 1; c < count; c++) {
+            if (nums[c] == search->phases[guess->cell]) {
+                int num = nums[c];
+                for (int d = c; d > 0; d--) {
+                    nums[d] = nums[d-1];
+                }
+                nums[0] = num;
+                break;
+            }
+        }
+    }
+}
+
+/* the numbers missing from the note of a guess are blamed on the levels keeping them out */
+static void search_blame_note(search_t *search, search_guess_t *guess, mask_t note)
+{
+    int level = guess - search->guesses;
+    level_t *conf = search->confs + search->words * level;
+
+    for (int n = 1; n <= search->scale; n++) {
+        if (!(note & mask_of(n))) {
+            search_explain(search, guess->cell, n, conf, level / 64 + 1);
+        }
+    }
+}
+
+void search_guess(search_t *search)
+{
+    int best = -1, bestcount = search->scale + 1, count;
+    long bestweight = 1, weight;
+    mask_t note;
+
+    profile_mark(PROFILE_GUESS, search->guessed);
+    for (int cell = 0; cell < search->size; cell++) {
+        if (search->map[cell] != 0) {
+            continue;
+        }
+        /* the first void */
+        if (search->branch == SEARCH_FIRST) {
+            best = cell;
+            break;
+        }
+        count = mask_count(search_note(search, cell));
+        /* the void with the fewest candidates per failure */
+        if (search->branch == SEARCH_WEIGHTED) {
+            weight = 1 + search->failures[cell];
+            if (best == -1 || count * bestweight < bestcount * weight) {
+                best = cell;
+                bestcount = count;
+                bestweight = weight;
+            }
+            continue;
+        }
+        /* the void with the fewest candidates */
+        if (count < bestcount) {
+            best = cell;
+            bestcount = count;
+            if (count <= 2) {
+                break;
+            }
+        }
+    }
+
+    /* copy the note which could be lost later */
+    search_guess_t *guess = search_push(search);
+    guess->cell = best;
+    note = search_note(search, best);
+    if (search->backjump) {
+        search_blame_note(search, guess, note);
+    }
+    while (note) {
+        guess->nums[guess->count++] = mask_first(note);
+        note &= note - 1;
+    }
+    search_order(search, guess);
+
+    search->nodes++;
+    search_place_guess(search, best, guess->nums[0]);
+}
+
+/* blame every guess, used when moving on from a solution or a frontier node */
+static void search_blame_all(search_t *search)
+{
+    for (int g = 0; g < search->guessed; g++) {
+        level_t *conf = search->confs + search->words * g;
+        for (int w = 0; w <= g / 64; w++) {
+            conf[w] = ~(level_t)0;
+        }
+        search->tainted[g] = 1;
+    }
+    for (int w = 0; w < search_words(search); w++) {
+        search->conflict[w] = ~(level_t)0;
+    }
+}
+
+/* withdraw to the last guess having choices left */
+static int search_drawback_last(search_t *search)
+{
+    search_guess_t *guess;
+
+    while (search->guessed > 0) {
+        guess = search->guesses + search->guessed - 1;
+        search_undo(search, guess->back);
+        if (guess->choice < guess->count - 1) {
+            guess->choice++;
+            search->nodes++;
+            search->drawbacks++;
+            search_place_guess(search, guess->cell, guess->nums[guess->choice]);
+            return 1;
+        }
+        /* guessed up already, throw it to the garbage */
+        search->guessed--;
+    }
+
+    return 0;
+}
+
+/* withdraw to the deepest guess blamed by the conflict */
+static int search_drawback_jump(search_t *search)
+{
+    level_t *conflict = search->conflict;
+    search_guess_t *guess;
+    int level;
+
+    while ((level = level_top(conflict, search->guessed)) != -1) {
+        /* the guesses above are innocent */
+        search->jumps += search->guessed - 1 - level;
+        search->guessed = level + 1;
+        guess = search->guesses + level;
+        search_undo(search, guess->back);
+
+        /* the other levels are blamed for this choice */
+        level_t *conf = search->confs + search->words * level;
+        conflict[level/64] &= ~((level_t)1 << (level % 64));
+        level_union(conf, conflict, level / 64 + 1);
+        if (guess->choice < guess->count - 1) {
+            guess->choice++;
+            search->nodes++;
+            search->drawbacks++;
+            search_place_guess(search, guess->cell, guess->nums[guess->choice]);
+            return 1;
+        }
+
+        /* guessed up already, the blame goes down */
+        memcpy(conflict, conf, sizeof(level_t) * (level / 64 + 1));
+        if (!search->tainted[level]) {
+            search_record(search, conflict, level);
+        }
+        search->guessed = level;
+    }
+
+    /* nothing to blame, no solution */
+    if (search->guessed > 0) {
+        search_undo(search, search->guesses[0].back);
+        search->guessed = 0;
+    }
+    return 0;
+}
+
+int search_drawback(search_t *search)
+{
+    profile_mark(PROFILE_DRAWBACK, search->guessed);
+    return search->backjump ? search_drawback_jump(search) : search_drawback_last(search);
+}
+
+int search_assume(search_t *search, int cell, int num)
+{
+    if (search->map[cell] != 0 || !(search_note(search, cell) & mask_of(num))) {
+        return 0;
+    }
+
+    if (search->guessed == search->assumed) {
+        search->assumed++;
+    }
+    search_guess_t *guess = search_push(search);
+    guess->cell = cell;
+    guess->count = 1;
+    guess->nums[0] = num;
+    /* the other numbers are left to other jobs, so its exhaustion is no nogood */
+    if (search->backjump) {
+        level_fill(search->confs + search->words * (search->guessed - 1), search->guessed - 1);
+        search->tainted[search->guessed-1] = 1;
+    }
+    search_place_guess(search, cell, num);
+
+    return 1;
+}
+
+/* the luby sequence 1, 1, 2, 1, 1, 2, 4, ... */
+static long search_luby(long x)
+{
+    long size = 1, seq = 0;
+    while (size < x + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        seq--;
+        x = x % size;
+    }
+    return 1L << seq;
+}
+
+/* guesses allowed for the current run */
+static long search_restart_limit(search_t *search)
+{
+    if (search->restart == SEARCH_LUBY) {
+        return search->restartbase * search_luby(search->restarts);
+    }
+    double limit = search->restartbase;
+    for (long r = 0; r < search->restarts && limit < LONG_MAX / 4; r++) {
+        limit *= search->restartgrowth;
+    }
+    return (long)limit;
+}
+
+/* withdraw every guess but the assumed ones, failures, phases and nogoods are kept */
+static void search_restart(search_t *search)
+{
+    if (search->guessed > search->assumed) {
+        search_undo(search, search->guesses[search->assumed].back);
+        search->guessed = search->assumed;
+    }
+    search->restarts++;
+    search->restartnodes = search->nodes;
+}
+
+int search_dive(search_t *search, int depth)
+{
+    if (search->clashes) {
+        return 0;
+    }
+
+    /* move on from where the last run stopped */
+    if (search->stopped) {
+        search->stopped = 0;
+        if (search->backjump) {
+            search_blame_all(search);
+        }
+        if (!search_drawback(search)) {
+            return 0;
+        }
+    }
+
+    while (1) {
+        if (search_propagate(search)) {
+            if (search->totalfill == search->totalvoid || search->guessed >= depth) {
+                search->stopped = 1;
+                search->found++;
+                return 1;
+            }
+            /* restarts would meet the found ones again, so only before the first */
+            if (search->restart != SEARCH_NEVER && search->found == 0
+                && search->nodes - search->restartnodes >= search_restart_limit(search)) {
+                search_restart(search);
+                continue;
+            }
+            if (search->pause && search->nodes >= search->pause) {
+                return -1;
+            }
+            search_guess(search);
+        }
+        else if (!search_drawback(search)) {
+            return 0;
+        }
+        else if (search->pause && search->nodes >= search->pause) {
+            /* the next choice is placed, the next call propagates it */
+            return -1;
+        }
+    }
+}
+
+int search_run(search_t *search)
+{
+    return search_dive(search, search->size);
+}
+
+int search_restore(search_t *search, cell_t *map, int *fills, int totalfill, search_guess_t *guesses, int guessed)
+{
+    int level = 0;
+    int cell, num;
+
+    search_reset(search);
+    for (int i = 0; i < totalfill; i++) {
+        cell = fills[i];
+        num = cell >= 0 && cell < search->size ? map[cell] : 0;
+        if (num < 1 || num > search->scale || search->map[cell] != 0
+            || !(search_note(search, cell) & mask_of(num))) {
+            search_reset(search);
+            return 0;
+        }
+
+        if (level < guessed && guesses[level].back == i) {
+            search_guess_t *saved = guesses + level;
+            if (saved->cell != cell || saved->choice < 0 || saved->choice >= saved->count
+                || saved->count > search->scale || saved->nums[saved->choice] != num) {
+                search_reset(search);
+                return 0;
+            }
+            search_guess_t *guess = search_push(search);
+            guess->cell = cell;
+            guess->choice = saved->choice;
+            guess->count = saved->count;
+            memcpy(guess->nums, saved->nums, sizeof(int) * saved->count);
+            /* the blame of the withdrawn choices is lost, so every level below is blamed */
+            if (search->backjump) {
+                level_fill(search->confs + search->words * level, level);
+                search->tainted[level] = 1;
+            }
+            search_place_guess(search, cell, num);
+            level++;
+        }
+        else {
+            if (search->backjump) {
+                level_fill(search->conflict, search->guessed);
+            }
+            search_place_with(search, cell, num, search_words(search));
+        }
+    }
+
+    /* the givens have to agree as well */
+    for (int i = 0; i < search->size; i++) {
+        if (search->map[i] != map[i]) {
+            level = -1;
+        }
+    }
+    if (level != guessed) {
+        search_reset(search);
+        return 0;
+    }
+
+    return 1;
+}
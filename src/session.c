@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT License
+/* session.c -- the incremental solver session
+ * an interactive front end edits one cell at a time, so the session keeps the masks of
+ * the givens and the last solution. an edit only touches the masks of three units, and
+ * the search is run again only if the edit invalidates the last solution.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <session.h>
+#include <search.h>
+#include <puzzle.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+session_t *session_create(puzzle_t *puzzle)
+{
+    search_t *search = search_create(puzzle);
+    if (search == NULL) {
+        return NULL;
+    }
+
+    session_t *session = malloc(sizeof(session_t));
+    session->search = search;
+    session->solution = malloc(sizeof(cell_t) * puzzle->size);
+    session->solved = 0;
+    session->nodes = 0;
+
+    return session;
+}
+
+void session_free(session_t *session)
+{
+    search_free(session->search);
+    free(session->solution);
+    free(session);
+}
+
+int session_set(session_t *session, int row, int col, int num)
+{
+    search_t *search = session->search;
+    int cell = search->scale * row + col;
+
+    if (row < 0 || row >= search->scale || col < 0 || col >= search->scale
+        || num < 1 || num > search->scale) {
+        return 0;
+    }
+    if (search->map[cell] == num) {
+        return 1;
+    }
+
+    if (search->map[cell] != 0) {
+        search_take(search, cell);
+    }
+    search_give(search, cell, num);
+
+    /* the last solution holds if it agrees with the new given */
+    if (session->solved != 1 || session->solution[cell] != num) {
+        session->solved = 0;
+    }
+
+    return 1;
+}
+
+int session_clear(session_t *session, int row, int col)
+{
+    search_t *search = session->search;
+    int cell = search->scale * row + col;
+
+    if (row < 0 || row >= search->scale || col < 0 || col >= search->scale) {
+        return 0;
+    }
+    if (search->map[cell] == 0) {
+        return 1;
+    }
+
+    search_take(search, cell);
+
+    /* fewer givens never break a solution, but may make one */
+    if (session->solved == -1) {
+        session->solved = 0;
+    }
+
+    return 1;
+}
+
+int session_solve(session_t *session)
+{
+    search_t *search = session->search;
+
+    if (session->solved != 0) {
+        return session->solved == 1;
+    }
+
+    search->nodes = 0;
+    if (search_run(search)) {
+        memcpy(session->solution, search->map, sizeof(cell_t) * search->size);
+        session->solved = 1;
+    }
+    else {
+        session->solved = -1;
+    }
+    session->nodes = search->nodes;
+    search_reset(search);
+
+    return session->solved == 1;
+}
@@ -6,6 +6,7 @@
 
 #include <solver.h>
 #include <puzzle.h>
+#include <profile.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -57,12 +58,13 @@ void solver_guess(note_t *notes, fill_t *fills, guess_t *guesses, state_t *state
 void solver_drawback(fill_t *fills, guess_t *guesses, state_t *states);
 
 /* main procedure of solving method */
-void solver_main(puzzle_t *puzzle)
+void solver_main(puzzle_t *puzzle, render_t *render)
 {
     int puzzle_scale = puzzle->scale;
     int puzzle_size = puzzle->size;
-    int *puzzle_map = puzzle->map;
-    puzzle_print_console(puzzle);
+    cell_t *puzzle_map = puzzle->map;
+    render_t *frames = render != NULL ? render : render_create(puzzle, RENDER_FULL, 0);
+    render_frame(frames, puzzle_map);
 
     /* initialize state information */
     state_t *states = malloc(sizeof(state_t));
@@ -118,14 +120,14 @@ void solver_main(puzzle_t *puzzle)
             solver_drawback(fills, guesses, states);
             /* another guess */
             solver_guess(notes, fills, guesses, states);
-            puzzle_print_console(puzzle);
+            render_frame(frames, puzzle_map);
             continue;
         }
         /* stage 2: update note more precisely */
         update_note_number(notes, states);
         /* fill in numbers avialable */
         solver_fill(notes, fills, states);
-        puzzle_print_console(puzzle);
+        render_frame(frames, puzzle_map);
         /* chech the map */
         solver_validate(states);
         if (states->error) {
@@ -133,15 +135,16 @@ void solver_main(puzzle_t *puzzle)
             solver_drawback(fills, guesses, states);
             /* another guess */
             solver_guess(notes, fills, guesses, states);
-            puzzle_print_console(puzzle);
+            render_frame(frames, puzzle_map);
             continue;
         }
         if (states->deadend) {
             /* dead end, guess a number */
             solver_guess(notes, fills, guesses, states);
-            puzzle_print_console(puzzle);
+            render_frame(frames, puzzle_map);
         }
     }
+    render_flush(frames, puzzle_map);
     printf("[okey] sudoku solved!\n\n");
     
     /* print fill history (no wrong guesses) */
@@ -175,6 +178,9 @@ void solver_main(puzzle_t *puzzle)
     free(guesses);
     free(fills);
     free(states);
+    if (render == NULL) {
+        render_free(frames);
+    }
 }
 
 void update_note_void(note_t *notes, state_t *states)
@@ -184,9 +190,10 @@ void update_note_void(note_t *notes, state_t *states)
      * 2. any note contains no number which implies error
      */
 
+    profile_mark(PROFILE_VOID, states->guessed);
     int puzzle_order = states->puzzle->order;
     int puzzle_scale = states->puzzle->scale;
-    int *puzzle_map = states->puzzle->map;
+    cell_t *puzzle_map = states->puzzle->map;
 
     int count; /* count of "what" */ 
     int found; /* if number duplicated */
@@ -268,9 +275,10 @@ void update_note_number(note_t *notes, state_t *states)
      * 2. any number only exists in one note in one col which means that is the answer
      */
 
+    profile_mark(PROFILE_NUMBER, states->guessed);
     int puzzle_order = states->puzzle->order;
     int puzzle_scale = states->puzzle->scale;
-    int *puzzle_map = states->puzzle->map;
+    cell_t *puzzle_map = states->puzzle->map;
 
     int count; /* count of "where" */
     int srow, scol; /* special location */
@@ -388,8 +396,9 @@ void solver_fill(note_t *notes, fill_t *fills, state_t *states)
      * 2. every note constains as least two numbers, that is called deadend
      */
 
+    profile_mark(PROFILE_FILL, states->guessed);
     int puzzle_scale = states->puzzle->scale;
-    int *puzzle_map = states->puzzle->map;
+    cell_t *puzzle_map = states->puzzle->map;
 
     int filled = 0; /* filled numbers for this run */
     note_t onenote;
@@ -431,9 +440,10 @@ void solver_validate(state_t *states)
      * 2. duplicated number in one row, col or chunk, error
      */
 
+    profile_mark(PROFILE_VALIDATE, states->guessed);
     int puzzle_order = states->puzzle->order;
     int puzzle_scale = states->puzzle->scale;
-    int *puzzle_map = states->puzzle->map;
+    cell_t *puzzle_map = states->puzzle->map;
 
     int count; /* count of number in one row, col or chunk */
     int csrow, cscol; /* start of a chunk */
@@ -501,8 +511,9 @@ void solver_guess(note_t *notes, fill_t *fills, guess_t *guesses, state_t *state
      * 4. not the problem of last guess, rollback (already handled by solver_drawback)
      */
 
+    profile_mark(PROFILE_GUESS, states->guessed);
     int puzzle_scale = states->puzzle->scale;
-    int *puzzle_map = states->puzzle->map;
+    cell_t *puzzle_map = states->puzzle->map;
 
     //int virgin; /* first or another */
     int grow = 0, gcol = 0; /* at the start of map as default */
@@ -577,8 +588,9 @@ void solver_drawback(fill_t *fills, guess_t *guesses, state_t *states)
      * 2. the number of earlier guess was wrong
      */
 
+    profile_mark(PROFILE_DRAWBACK, states->guessed);
     int puzzle_scale = states->puzzle->scale;
-    int *puzzle_map = states->puzzle->map;
+    cell_t *puzzle_map = states->puzzle->map;
 
     int grow, gcol;
     guess_t oneguess;
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: MIT License
+/* task.c -- resumable solving tasks and their round robin
+ * a task wraps a search paused by its node count, so a step does a bounded amount of work
+ * and the next step goes on from the same node. one thread can then keep many puzzles in
+ * flight, stepping them in turn, and an easy puzzle is not stuck behind a hard one.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <task.h>
+#include <search.h>
+#include <puzzle.h>
+
+#include <stdlib.h>
+
+task_t *task_create(puzzle_t *puzzle)
+{
+    search_t *search = search_create(puzzle);
+    if (search == NULL) {
+        return NULL;
+    }
+
+    task_t *task = malloc(sizeof(task_t));
+    task->search = search;
+    task->state = TASK_RUNNING;
+    task->steps = 0;
+    task->data = NULL;
+
+    return task;
+}
+
+void task_free(task_t *task)
+{
+    search_free(task->search);
+    free(task);
+}
+
+int task_step(task_t *task, long maxnodes)
+{
+    search_t *search = task->search;
+
+    if (task->state != TASK_RUNNING) {
+        return task->state;
+    }
+
+    search->pause = maxnodes > 0 ? search->nodes + maxnodes : 0;
+    int result = search_run(search);
+    search->pause = 0;
+    task->steps++;
+
+    if (result == 1) {
+        task->state = TASK_SOLVED;
+    }
+    else if (result == 0) {
+        task->state = TASK_UNSOLVABLE;
+    }
+    return task->state;
+}
+
+schedule_t *schedule_create(int capacity, long slice)
+{
+    schedule_t *schedule = malloc(sizeof(schedule_t));
+    schedule->tasks = malloc(sizeof(task_t *) * capacity);
+    schedule->capacity = capacity;
+    schedule->head = 0;
+    schedule->count = 0;
+    schedule->slice = slice;
+
+    return schedule;
+}
+
+void schedule_free(schedule_t *schedule)
+{
+    free(schedule->tasks);
+    free(schedule);
+}
+
+int schedule_add(schedule_t *schedule, task_t *task)
+{
+    if (schedule->count == schedule->capacity) {
+        return 0;
+    }
+    schedule->tasks[(schedule->head + schedule->count) % schedule->capacity] = task;
+    schedule->count++;
+
+    return 1;
+}
+
+task_t *schedule_next(schedule_t *schedule)
+{
+    if (schedule->count == 0) {
+        return NULL;
+    }
+
+    task_t *task = schedule->tasks[schedule->head];
+    schedule->head = (schedule->head + 1) % schedule->capacity;
+    schedule->count--;
+    if (task_step(task, schedule->slice) != TASK_RUNNING) {
+        return task;
+    }
+
+    /* back to the end of the round */
+    schedule_add(schedule, task);
+    return NULL;
+}
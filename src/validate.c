@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: MIT License
+/* validate.c -- bulk grid validation
+ * a grid is valid if no number is held twice by a row, col or chunk, so one pass over the
+ * cells with a mask of seen numbers for every unit is enough, instead of comparing cells.
+ * grids of order 3 and 4 are checked VALIDATE_LANES at a time in the lanes of a vector of
+ * 16-bit masks, the same way the batch solver propagates, and other orders one by one.
+ * lines of compact format are checked straight from the text, since parsing them into
+ * maps would cost more than the check itself.
+ *
+ * Copyright (C) 2025 Wen-Xuan Zhang <serialcore@outlook.com>
+ */
+
+#include <validate.h>
+#include <search.h>
+#include <corpus.h>
+#include <puzzle.h>
+
+#include <stdlib.h>
+
+typedef unsigned short validate_vec_t __attribute__((vector_size(2 * VALIDATE_LANES)));
+
+/* numbers out of scale in lanes */
+#define VALIDATE_OUT 0xffff
+
+int validate_map(cell_t *map, int order, int complete)
+{
+    int scale = order * order;
+    mask_t units[3*128];
+    int voids = 0;
+
+    if (scale > 128) {
+        return VALIDATE_RANGE;
+    }
+    for (int u = 0; u < 3 * scale; u++) {
+        units[u] = 0;
+    }
+    for (int i = 0; i < scale; i++) {
+        for (int j = 0; j < scale; j++) {
+            int num = map[scale*i+j];
+            if (num > scale) {
+                return VALIDATE_RANGE;
+            }
+            if (num == 0) {
+                voids++;
+                continue;
+            }
+            mask_t bit = mask_of(num);
+            mask_t *row = units + i, *col = units + scale + j;
+            mask_t *chunk = units + 2 * scale + i / order * order + j / order;
+            if ((*row | *col | *chunk) & bit) {
+                return VALIDATE_CLASH;
+            }
+            *row |= bit;
+            *col |= bit;
+            *chunk |= bit;
+        }
+    }
+
+    return complete && voids ? VALIDATE_INCOMPLETE : VALIDATE_OK;
+}
+
+/* check the numbers of every cell in lanes for grids of order 3 or 4 */
+static void validate_kernel(validate_vec_t *nums, int order, int count, int complete, int *results)
+{
+    int scale = order * order;
+    const validate_vec_t one = (validate_vec_t){0} + 1;
+    const validate_vec_t top = (validate_vec_t){0} + (unsigned short)scale;
+    validate_vec_t units[3*16];
+    validate_vec_t clash = {0}, range = {0}, voids = {0};
+
+    for (int u = 0; u < 3 * scale; u++) {
+        units[u] = (validate_vec_t){0};
+    }
+    for (int i = 0; i < scale; i++) {
+        for (int j = 0; j < scale; j++) {
+            validate_vec_t num = nums[scale*i+j];
+            validate_vec_t over = (validate_vec_t)(num > top);
+            validate_vec_t none = (validate_vec_t)(num == 0);
+            validate_vec_t bit = (one << ((num - one) & 15)) & ~over & ~none;
+            range |= over;
+            voids |= none;
+
+            validate_vec_t *row = units + i, *col = units + scale + j;
+            validate_vec_t *chunk = units + 2 * scale + i / order * order + j / order;
+            clash |= (*row | *col | *chunk) & bit;
+            *row |= bit;
+            *col |= bit;
+            *chunk |= bit;
+        }
+    }
+
+    for (int l = 0; l < count; l++) {
+        results[l] = range[l] ? VALIDATE_RANGE : clash[l] ? VALIDATE_CLASH
+            : complete && voids[l] ? VALIDATE_INCOMPLETE : VALIDATE_OK;
+    }
+}
+
+/* check up to VALIDATE_LANES maps of order 3 or 4 in lockstep */
+static void validate_lanes(puzzle_t **puzzles, int count, int order, int complete, int *results)
+{
+    validate_vec_t nums[256];
+    int size = order * order * order * order;
+
+    for (int i = 0; i < size; i++) {
+        nums[i] = (validate_vec_t){0};
+        for (int l = 0; l < count; l++) {
+            int num = puzzles[l]->map[i];
+            nums[i][l] = num <= order * order ? num : VALIDATE_OUT;
+        }
+    }
+    validate_kernel(nums, order, count, complete, results);
+}
+
+/* check up to VALIDATE_LANES compact lines of order 3 or 4 in lockstep */
+static void validate_text(char **lines, int count, int order, int complete, int *results)
+{
+    const signed char *numbers = corpus_numbers();
+    validate_vec_t nums[256];
+    int size = order * order * order * order;
+
+    for (int i = 0; i < size; i++) {
+        nums[i] = (validate_vec_t){0};
+        for (int l = 0; l < count; l++) {
+            int num = numbers[(unsigned char)lines[l][i]];
+            nums[i][l] = num >= 0 ? num : VALIDATE_OUT;
+        }
+    }
+    validate_kernel(nums, order, count, complete, results);
+}
+
+int validate_puzzles(puzzle_t **puzzles, int count, int complete, int *results)
+{
+    puzzle_t *lanes[2][VALIDATE_LANES];
+    int *slots[2][VALIDATE_LANES];
+    int found[VALIDATE_LANES];
+    int used[2] = {0, 0};
+    int valid = 0;
+
+    for (int p = 0; p <= count; p++) {
+        for (int k = 0; k < 2; k++) {
+            /* a full group, or the groups left at the end */
+            if (used[k] == VALIDATE_LANES || (p == count && used[k] > 0)) {
+                validate_lanes(lanes[k], used[k], k + 3, complete, found);
+                for (int l = 0; l < used[k]; l++) {
+                    *slots[k][l] = found[l];
+                }
+                used[k] = 0;
+            }
+        }
+        if (p == count) {
+            break;
+        }
+        int order = puzzles[p]->order;
+        if (order == 3 || order == 4) {
+            lanes[order-3][used[order-3]] = puzzles[p];
+            slots[order-3][used[order-3]++] = results + p;
+        }
+        else {
+            results[p] = validate_map(puzzles[p]->map, order, complete);
+        }
+    }
+
+    for (int p = 0; p < count; p++) {
+        valid += results[p] == VALIDATE_OK;
+    }
+    return valid;
+}
+
+int validate_compact(char **lines, int *lengths, int count, int complete, int *results)
+{
+    char *lanes[2][VALIDATE_LANES];
+    int *slots[2][VALIDATE_LANES];
+    int found[VALIDATE_LANES];
+    int used[2] = {0, 0};
+    int valid = 0;
+    cell_t *map = NULL;
+
+    for (int p = 0; p <= count; p++) {
+        for (int k = 0; k < 2; k++) {
+            if (used[k] == VALIDATE_LANES || (p == count && used[k] > 0)) {
+                validate_text(lanes[k], used[k], k + 3, complete, found);
+                for (int l = 0; l < used[k]; l++) {
+                    *slots[k][l] = found[l];
+                }
+                used[k] = 0;
+            }
+        }
+        if (p == count) {
+            break;
+        }
+        int order = corpus_order(lengths[p]);
+        if (order == 3 || order == 4) {
+            lanes[order-3][used[order-3]] = lines[p];
+            slots[order-3][used[order-3]++] = results + p;
+        }
+        else if (order > 0) {
+            /* other orders are parsed, a symbol out of the format is out of scale */
+            map = realloc(map, sizeof(cell_t) * lengths[p]);
+            const signed char *numbers = corpus_numbers();
+            int known = 1;
+            for (int i = 0; i < lengths[p]; i++) {
+                map[i] = numbers[(unsigned char)lines[p][i]];
+                known &= numbers[(unsigned char)lines[p][i]] >= 0;
+            }
+            results[p] = known ? validate_map(map, order, complete) : VALIDATE_RANGE;
+        }
+        else {
+            results[p] = VALIDATE_RANGE;
+        }
+    }
+    free(map);
+
+    for (int p = 0; p < count; p++) {
+        valid += results[p] == VALIDATE_OK;
+    }
+    return valid;
+}